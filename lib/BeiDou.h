@@ -16,6 +16,10 @@ constexpr uint32_t WEEKNUM_MAX = 8191;
 
 constexpr uint32_t BDS_PREABMLE = 1810;
 
+// single layer of the ionosphere, ICD 5.2.4.7
+constexpr double BDS_EARTH_RADIUS = 6378.0e3;
+constexpr double BDS_IONOSPHERE_HEIGHT = 375.0e3;
+
 constexpr double BDS_B1I_FREQ = 1561.098e6;
 constexpr double BDS_B2I_FREQ = 1207.140e6;
 
@@ -25,12 +29,34 @@ constexpr uint32_t BDS_MAX_PRN_GEO = 5;
 constexpr std::size_t D1_FRAME_SIZE[] = {1, 1, 1, 24, 24};
 // one subframe has a duration of 6s
 constexpr uint32_t D1_SUBFRAME_DURATION = 6;
+// one frame has a duration of 30s (6s * 5), subframes 4 and 5 change their
+// page with every frame
+constexpr uint32_t D1_FRAME_DURATION = 30;
+// one superframe consists of 24 frames (12min)
+constexpr uint32_t D1_SUPERFRAME_DURATION = 24 * D1_FRAME_DURATION;
 
 constexpr std::size_t D2_FRAME_SIZE[] = {10, 6, 6, 6, 120};
 // one frame has a duration of 3s (0.6s * 5)
 // D2 has the same SOW for all subframes of one frame
 constexpr uint32_t D2_FRAME_DURATION = 3;
 
+// D2 frame 1: WN and SOW are at page 1, Klobuchar parameters at page 2
+constexpr std::size_t D2_KLOBUCHAR_PAGES = 2;
+
+// ephemeris and clock parameters are updated every hour
+constexpr uint32_t EPHEMERIS_UPDATE_INTERVAL = 3600;
+
+// Klobuchar parameters are updated every two hours
+constexpr uint32_t KLOBUCHAR_UPDATE_INTERVAL = 7200;
+
+// regional grid is broadcast every six minutes
+constexpr uint32_t REGIONAL_GRID_UPDATE_INTERVAL = 360;
+
+// D2 frame 5: ionospheric grid is at pages 1 to 13 (IGP <= 160) and
+// pages 61 to 73 (IGP > 160)
+constexpr std::size_t D2_IONOSPHERE_BLOCK_SIZE = 13;
+constexpr std::size_t D2_IONOSPHERE_BLOCK_FIRSTPAGE[] = {1, 61};
+
 enum class SignalType
 {
     BDS_B1,
@@ -1,4 +1,5 @@
 #include "Ephemeris.h"
+#include "BeiDou.h"
 
 namespace bnav
 {
@@ -102,8 +103,8 @@ bool Ephemeris::operator==(const Ephemeris &rhs) const
 
 void Ephemeris::loadD1(const SubframeBufferParam &sfbuf)
 {
-    // ensure there is one subframe
-    assert(sfbuf.data.size() == 3);
+    // subframe 1 is enough, subframes 2 and 3 are not parsed
+    assert(sfbuf.framecount == 3 || sfbuf.framecount == 1);
 
     processD1Subframe1(sfbuf.data[0][0]);
 }
@@ -111,7 +112,7 @@ void Ephemeris::loadD1(const SubframeBufferParam &sfbuf)
 void Ephemeris::processD1Subframe1(const Subframe &sf)
 {
     assert(sf.getPageNum() == 0);
-    const NavBits<300> bits { sf.getBits() };
+    const NavBits<300> &bits = sf.getBits();
 
     m_sow = sf.getSOW();
     m_weeknum = bits.getLeft<60, 13>().to_uint32_t();
@@ -171,11 +172,11 @@ void Ephemeris::processD1Subframe1(const Subframe &sf)
 void Ephemeris::loadD2(const SubframeBufferParam &sfbuf)
 {
     // ensure there is one subframe
-    assert(sfbuf.data.size() == 1);
+    assert(sfbuf.framecount == 1);
 
-    const SubframeVector vfra = sfbuf.data[0];
-    // ensure there are all pages
-    assert(vfra.size() == 10);
+    const SubframeSpan &vfra = sfbuf.data[0];
+    // all pages or at least pages 1 and 2, the others are not parsed
+    assert(vfra.size() == D2_FRAME_SIZE[0] || vfra.size() == D2_KLOBUCHAR_PAGES);
 
     processD2Page1(vfra[0]);
     processD2Page2(vfra[1]);
@@ -191,7 +192,7 @@ void Ephemeris::loadD2(const SubframeBufferParam &sfbuf)
 void Ephemeris::processD2Page1(const Subframe &sf)
 {
     assert(sf.getPageNum() == 1);
-    const NavBits<300> bits { sf.getBits() };
+    const NavBits<300> &bits = sf.getBits();
 
     // date of issue of ionospheric model is at page 1 of subframe 1
     // [1] 5.3.3.1 Basic NAV Information, p. 68
@@ -218,7 +219,7 @@ void Ephemeris::processD2Page1(const Subframe &sf)
 void Ephemeris::processD2Page2(const Subframe &sf)
 {
     assert(sf.getPageNum() == 2);
-    const NavBits<300> bits { sf.getBits() };
+    const NavBits<300> &bits = sf.getBits();
     NavBits<64> allbits;
 
     // alpha0
@@ -68,24 +68,6 @@ std::string lcl_justifyRight(const double num, const std::string::size_type leng
     return lcl_justifyRight(ss.str(), length, padding);
 }
 
-static const bnav::Ionosphere lcl_dummyModel(const bnav::Ionosphere &data, const bnav::DateTime &dt)
-{
-    const bnav::IonoGridDimension dim = data.getGridDimension();
-    bnav::Ionosphere ionoref;
-    ionoref.setGridDimension(dim);
-    ionoref.setDateOfIssue(dt);
-    // get grid and reuse tecu as counter ;)
-    std::vector<bnav::IonoGridInfo> igpref = ionoref.getGrid();
-
-    // zero initialize every single IGP
-    for (auto it = igpref.begin(); it != igpref.end(); ++it)
-        it->setVerticalDelay_TECU(9999);
-
-    ionoref.setGrid(igpref);
-
-    return ionoref;
-}
-
 }
 
 namespace bnav
@@ -98,6 +80,10 @@ IonexWriter::IonexWriter()
     , m_isKlobuchar(false)
     , m_isHeaderWritten(false)
     , m_tecmapcount(0)
+    , m_griddim()
+    , m_hasLastMap(false)
+    , m_lastweek(0)
+    , m_lastsec(0)
 {
 }
 
@@ -108,6 +94,10 @@ IonexWriter::IonexWriter(const char *filename, const std::uint32_t interval, con
     , m_isKlobuchar(klobuchar)
     , m_isHeaderWritten(false)
     , m_tecmapcount(0)
+    , m_griddim()
+    , m_hasLastMap(false)
+    , m_lastweek(0)
+    , m_lastsec(0)
 {
     open(filename);
 }
@@ -161,9 +151,13 @@ void IonexWriter::setKlobuchar(const bool klobuchar)
     m_isKlobuchar = klobuchar;
 }
 
-/// called from writeData, because we need at least one data record to get
-/// all information of the map.
-void IonexWriter::writeHeader(const Ionosphere &firstion, const Ionosphere &lastion)
+/**
+ * @brief IonexWriter::writeHeader Write the header, before any map.
+ * @param first Epoch of the first map.
+ * @param last Epoch of the last map.
+ * @param igd Grid dimension of all maps.
+ */
+void IonexWriter::writeHeader(const DateTime &first, const DateTime &last, const IonoGridDimension &igd)
 {
     assert(isOpen());
 
@@ -185,7 +179,7 @@ void IonexWriter::writeHeader(const Ionosphere &firstion, const Ionosphere &last
         m_outfile << lcl_justifyLeft(*it, 60)
                   << lcl_justifyLeft("DESCRIPTION", 20) << std::endl;
 
-    const DateTime dtfirst = firstion.getDateOfIssue();
+    const DateTime &dtfirst = first;
     m_outfile << lcl_justifyRight(dtfirst.getYearString(), 6)
               << lcl_justifyRight(dtfirst.getMonthString(), 6)
               << lcl_justifyRight(dtfirst.getDayString(), 6)
@@ -196,7 +190,7 @@ void IonexWriter::writeHeader(const Ionosphere &firstion, const Ionosphere &last
               << lcl_justifyLeft("EPOCH OF FIRST MAP", 20)
               << std::endl;
 
-    const DateTime dtlast = lastion.getDateOfIssue();
+    const DateTime &dtlast = last;
     m_outfile << lcl_justifyRight(dtlast.getYearString(), 6)
               << lcl_justifyRight(dtlast.getMonthString(), 6)
               << lcl_justifyRight(dtlast.getDayString(), 6)
@@ -212,7 +206,7 @@ void IonexWriter::writeHeader(const Ionosphere &firstion, const Ionosphere &last
 
     // calculate total map count from interval, because we fill non existing
     // data records with dummies (9999).
-    const uint32_t totalsec = static_cast<uint32_t>(std::abs((lastion.getDateOfIssue() - firstion.getDateOfIssue()).total_seconds()));
+    const uint32_t totalsec = static_cast<uint32_t>(std::abs((last - first).total_seconds()));
     const uint32_t mapcount = totalsec / m_interval + 1; // fence posts
     m_outfile << lcl_justifyRight(std::to_string(mapcount), 6) << lcl_justifyLeft("", 54)
               << lcl_justifyLeft("# OF MAPS IN FILE", 20) << std::endl;
@@ -241,7 +235,6 @@ void IonexWriter::writeHeader(const Ionosphere &firstion, const Ionosphere &last
               << lcl_justifyLeft("", 40)
               << lcl_justifyLeft("HGT1 / HGT2 / DHGT", 20) << std::endl;
 
-    const IonoGridDimension igd = firstion.getGridDimension();
     m_outfile << lcl_justifyLeft("", 2)
               << lcl_justifyRight(igd.latitude_north, 6, 1)
               << lcl_justifyRight(igd.latitude_south, 6, 1)
@@ -265,6 +258,7 @@ void IonexWriter::writeHeader(const Ionosphere &firstion, const Ionosphere &last
     m_outfile << lcl_justifyLeft("", 60)
               << lcl_justifyLeft("END OF HEADER", 20) << std::endl;
 
+    m_griddim = igd;
     m_isHeaderWritten = true;
 }
 
@@ -273,78 +267,75 @@ void IonexWriter::writeHeader(const Ionosphere &firstion, const Ionosphere &last
  * finalizes the file.
  * @param data Ionospheric models.
  */
-void IonexWriter::writeAll(const std::map<DateTime, Ionosphere> &data)
+void IonexWriter::writeAll(const TimeSeries<Ionosphere> &data)
 {
     assert(!data.empty());
-    const Ionosphere firstion = data.begin()->second;
-    const Ionosphere lastion = data.rbegin()->second;
 
     // write header
-    writeHeader(firstion, lastion);
+    writeHeader(data.getDateTime(0), data.getDateTime(data.size() - 1), data.front().getGridDimension());
 
     // run through all models
-    std::uint32_t lastsec { 0 };
-    std::uint32_t lastweek { 0 };
-    // use a separate boolean, because SOW could be zero
-    bool firstentry { true };
-    for (auto it = data.begin(); it != data.end(); ++it)
+    for (const Ionosphere &iono : data)
+        writeMap(iono.getDateOfIssue(), iono.getGrid());
+
+    // finalize file
+    finalize();
+}
+
+/**
+ * @brief IonexWriter::writeMap Write the next map, a data gap since the last
+ * map is filled with dummies (9999).
+ * @param dt Epoch of the map, later than the last one.
+ * @param grid The grid, dimension as in the header.
+ */
+void IonexWriter::writeMap(const DateTime &dt, const IonoGrid &grid)
+{
+    std::cout << "=> Writing: " << dt.getDateTimeString() << std::endl;
+    // if we write the first entry, we don't have to close a data gap before
+    if (m_hasLastMap)
     {
-        std::cout << "=> Writing: " << it->second.getDateOfIssue().getDateTimeString() << std::endl;
-        // if we write the first entry, we don't have to close a data gap before
-        if (firstentry)
+        // look if we have to fill with fake entries, because there is a data gap
+        std::size_t sow = dt.getSOW();
+        // in case there is a week change
+        if (sow == 0)
         {
-           firstentry = false;
+            assert(m_lastsec + m_interval == SECONDS_OF_A_WEEK);
+            sow = m_lastsec + m_interval;
         }
-        else
+        const std::size_t secdiff = sow - m_lastsec;
+        const std::size_t fillcount = secdiff / m_interval;
+        assert(secdiff % m_interval == 0);
+
+        // fill one less, because we want to fill "fences" not "fence posts"
+        if (fillcount > 1)
         {
-            // look if we have to fill with fake entries, because there is a data gap
-            std::size_t sow = it->second.getDateOfIssue().getSOW();
-            // in case there is a week change
-            if (sow == 0)
-            {
-                assert(lastsec + m_interval == SECONDS_OF_A_WEEK);
-                sow = lastsec + m_interval;
-            }
-            const std::size_t secdiff = sow - lastsec;
-            const std::size_t fillcount = secdiff / m_interval;
-            assert(secdiff % m_interval == 0);
-            // fill one less, because we want to fill "fences" not "fence posts"
+            const IonoGrid dummy(m_griddim.getItemCountLatitude() * m_griddim.getItemCountLongitude(), IonoGridInfo(9999));
             for (std::uint32_t i = 1; i < fillcount; ++i)
             {
                 std::cout << "IonexWriter: Inserting dummy entry" << std::endl;
-
-                const DateTime dt(TimeSystem::BDT, lastweek, lastsec + m_interval * i);
-                writeRecord(std::make_pair(dt, lcl_dummyModel(it->second, dt)));
+                writeRecord(DateTime(TimeSystem::BDT, m_lastweek, m_lastsec + m_interval * i), dummy);
             }
         }
-
-        // write true entry
-        writeRecord(*it);
-        lastsec = it->second.getDateOfIssue().getSOW();
-        lastweek = it->second.getDateOfIssue().getWeekNum();
     }
 
-    // finalize file
-    finalize();
+    // write true entry
+    writeRecord(dt, grid);
+    m_hasLastMap = true;
+    m_lastsec = dt.getSOW();
+    m_lastweek = dt.getWeekNum();
 }
 
-void IonexWriter::writeRecord(const std::pair<const DateTime, Ionosphere> &data)
+void IonexWriter::writeRecord(const DateTime &dt, const IonoGrid &grid)
 {
     assert(isOpen());
     assert(m_isHeaderWritten);
 
     ++m_tecmapcount;
 
-    const IonoGridDimension igd = data.second.getGridDimension();
-    const std::vector<IonoGridInfo> grid = data.second.getGrid();
-    const DateTime dt = data.second.getDateOfIssue();
-
+    const IonoGridDimension &igd = m_griddim;
     const std::uint32_t colcount = igd.getItemCountLongitude();
     const std::uint32_t rowcount = igd.getItemCountLatitude();
-
-    // set an arbitrary limit
-    assert(colcount < 360);
-    assert(rowcount < 360);
+    assert(grid.size() == colcount * rowcount);
 
     // START OF TEC MAP: with index number
     m_outfile << lcl_justifyRight(std::to_string(m_tecmapcount), 6)
@@ -381,7 +372,7 @@ void IonexWriter::writeRecord(const std::pair<const DateTime, Ionosphere> &data)
         // data
         for (std::uint32_t col = 0; col < colcount; ++col)
         {
-            m_outfile << std::setw(5) << grid[index].getVerticalDelay_TECU();
+            m_outfile << std::setw(5) << grid.getVerticalDelay_TECU(index);
 
             // we have to insert a break after every 16 enries
             if (col > 0 && (col + 1) % 16 == 0)
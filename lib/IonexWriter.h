@@ -3,10 +3,12 @@
 
 #include "DateTime.h"
 #include "Ionosphere.h"
+#include "TimeSeriesStore.h"
+#include "IonosphereGrid.h"
 
 #include <fstream>
 #include <string>
-#include <map>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 
@@ -21,6 +23,10 @@ class IonexWriter : private boost::noncopyable
     bool m_isKlobuchar; ///< Write Klobuchar or regional model
     bool m_isHeaderWritten;
     std::size_t m_tecmapcount; ///< Index of current TEC map
+    IonoGridDimension m_griddim; ///< of all maps, set by the header
+    bool m_hasLastMap;
+    std::uint32_t m_lastweek; ///< epoch of the last written map
+    std::uint32_t m_lastsec;
 
 public:
     IonexWriter();
@@ -36,14 +42,16 @@ public:
     bool isKlobuchar() const;
     void setKlobuchar(const bool klobuchar = true);
 
-    void writeAll(const std::map<DateTime, Ionosphere> &data);
+    void writeAll(const TimeSeries<Ionosphere> &data);
+
+    void writeHeader(const DateTime &first, const DateTime &last, const IonoGridDimension &igd);
+    void writeMap(const DateTime &dt, const IonoGrid &grid);
+    void finalize();
 
     void close();
 
 private:
-    void writeHeader(const Ionosphere &firstion, const Ionosphere &lastion);
-    void writeRecord(const std::pair<const DateTime, Ionosphere> &data);
-    void finalize();
+    void writeRecord(const DateTime &dt, const IonoGrid &grid);
 };
 
 } // namespace bnav
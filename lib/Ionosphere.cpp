@@ -2,6 +2,7 @@
 #include "BeiDou.h"
 #include "NavBits.h"
 #include "SubframeBuffer.h"
+#include "KlobucharEvaluator.h"
 
 #include <cmath>
 #include <iostream>
@@ -9,75 +10,34 @@
 namespace
 {
 
+/// IGPs of one table, transmitted at one page block
+constexpr std::size_t IGP_TABLE_SIZE = 160;
+/// Ion elements of a page, the last page of a block has only 4
+constexpr std::size_t IONS_PER_PAGE = 13;
+constexpr std::size_t IONS_LAST_PAGE = IGP_TABLE_SIZE - (bnav::D2_IONOSPHERE_BLOCK_SIZE - 1) * IONS_PER_PAGE;
+
 /**
- * @brief lcl_calcKlobucharCorrectionBDS Calculate Klobuchar correction at position
- * (phi, lambda). This is only vertical delay, no slant!
- *
- * @param klob Klobuchar parameters.
- * @param time Local time.
- * @param phi Phi in degrees, west of Greenwich is negative.
- * @param lambda Lambda in degrees, south of equator is negative.
- * @return Vertical delay in meters.
- *
- * References:
- * [1] ICD, 5.2.4.7 Ionospheric Delay Model Parameters, pp. 25
- * [2] Ionospheric Time-Delay Algorithm for Single Frequency GPS Users,
- *     John. A. Klobuchar, 1987
- * [3] http://www.navipedia.net/index.php/Klobuchar_Ionospheric_Model
+ * Position of an 13 bit Ion element (dt and givei) in a page. Most elements
+ * are splitted by parity information into a msb and a lsb part.
  */
-double lcl_calcKlobucharCorrectionBDS(const bnav::KlobucharParam &klob, const uint32_t time, const double phi, const double lambda)
+struct IonField
 {
-    assert(time < 86400);
-
-    // convert to semicircle
-    double semiphi { phi / 180.0 };
-    double semilambda { lambda / 180.0 };
-
-    // chinese don't do geomagnetic latitude
-    double absphim { std::fabs(semiphi) };
-
-    int32_t localtime { static_cast<int32_t>(std::lround(4.32e4 * semilambda)) + static_cast<int32_t>(time) };
-
-    if (localtime > 86400)
-        localtime = localtime - 86400;
-    if (localtime < 0)
-        localtime = localtime + 86400;
-
-    double amplitude { klob.alpha0 + absphim * (klob.alpha1 + absphim * (klob.alpha2 + absphim * klob.alpha3)) };
-    double period { klob.beta0 + absphim * (klob.beta1 + absphim * (klob.beta2 + absphim * klob.beta3)) };
-
-    // amplitude is negative on the southern sphere
-    // changing the sign isn't much better.
-    if (amplitude < 0.0)
-        amplitude = 0.0;
-    if (period < 72000.0)
-        period = 72000.0;
-    // this causes the vertical line:
-    if (period > 172800.0)
-        period = 172800.0;
-
-    double tiono;
-
-    // ignore slant factor F, because we want vertical delay
-    if (std::abs(localtime - 50400) < (period / 4.0))
-    {
-        // offset 50400 is 14h at local time, this is when ionospheric delay
-        // reaches maximum usually
-        const double x = { 2 * bnav::PI * (localtime - 50400) / period };
-
-        //std::cout << "x: " << x << std::endl;
-
-        tiono = 5.0e-9 + amplitude * std::cos(x);
-    }
-    else
-        tiono = 5.0e-9;
-
-    // we have time atm
-    return tiono * bnav::SPEED_OF_LIGHT;
-}
+    std::size_t msb;
+    std::size_t msb_len;
+    std::size_t lsb;
+    std::size_t lsb_len; ///< 0, if not splitted
+};
+
+// [1] 5.3.2 D2 NAV Message Detailed structure, p. 50
+constexpr IonField ION_FIELDS[IONS_PER_PAGE] {
+    {50, 2, 60, 11}, {71, 11, 90, 2}, {92, 13, 0, 0}, {105, 7, 120, 6},
+    {126, 13, 0, 0}, {139, 3, 150, 10}, {160, 12, 180, 1}, {181, 13, 0, 0},
+    {194, 8, 210, 5}, {215, 13, 0, 0}, {228, 4, 240, 9}, {249, 13, 0, 0},
+    {270, 13, 0, 0}
+};
 
 /**
- * @brief lcl_convertChineseToEuropeanGrid Convert chinese numbering to european
+ * @brief lcl_getEuropeanIndex Convert chinese numbering to european
  * numbering. Chinese is column-wise bottom up from the left. European is
  * row-wise from top to bottom.
  *
@@ -89,58 +49,31 @@ double lcl_calcKlobucharCorrectionBDS(const bnav::KlobucharParam &klob, const ui
  *  2  12 22 ..  ..           144  ..  .. .. 160
  *  1  11 21 .. 151
  *
- * @param grid_chinese Grid in chinese format, see ICD p. 72.
+ * Rows of table 1 (IGP > 160) follow those of table 0, so a grid row has 32
+ * IGPs.
+ *
+ * @param igp Chinese IGP number - 1, see ICD p. 72.
+ * @return Index in the european grid.
  */
-std::vector<bnav::IonoGridInfo> lcl_convertChineseToEuropeanGrid(std::vector<bnav::IonoGridInfo> grid_chinese)
+constexpr std::size_t lcl_getEuropeanIndex(const std::size_t igp)
 {
-    std::vector<bnav::IonoGridInfo> grid;
-
-    for (std::size_t row = 10; row > 0; --row)
-    {
-        // we use a single row vector for m_grid
-        // table 0 is IGP <= 160
-        // table 1 is IGP > 160 -> has an offset of 160
-        for (std::size_t table = 0; table <= 1; ++table)
-        {
-            for (std::size_t col = 0; col <= 15; ++col)
-            {
-                // calc IGP num formula: col * 10 + row
-                // + table * 160, to access both IGP tables
-                // array index is then -1
-                std::size_t index = col * 10 + (table * 160) + row - 1;
-                grid.push_back(grid_chinese[index]);
-            }
-        }
-    }
+    return (9 - igp % IGP_TABLE_SIZE % 10) * 32 + igp / IGP_TABLE_SIZE * 16 + igp % IGP_TABLE_SIZE / 10;
+}
 
-    return grid;
+uint32_t lcl_getLeftBits(const bnav::NavBits<300> &bits, const std::size_t start, const std::size_t len)
+{
+    uint32_t value = 0;
+    for (std::size_t i = start; i < start + len; ++i)
+        value = (value << 1) | static_cast<uint32_t>(bits.atLeft(i));
+    return value;
 }
 
-/**
- * Parse an 13 bit ionospheric info element (dt and givei), which is splitted by
- * parity information. This helper is used to collect msb and lsb blocks and
- * to merge them.
- */
-template <std::size_t msb, std::size_t msb_len,
-          std::size_t lsb, std::size_t lsb_len>
-bnav::NavBits<13> lcl_parsePageIon(const bnav::NavBits<300> &bits)
+uint32_t lcl_parsePageIon(const bnav::NavBits<300> &bits, const IonField &field)
 {
-    // msb bits have to be left of lsb bits
-    assert(msb < lsb);
-    assert(msb + msb_len < lsb);
-    // we need this method to skip parities, check if we skip 8 bits
-    assert(msb + msb_len + 8 == lsb);
-    // one Ion element is 13 bits long
-    assert(msb_len + lsb_len == 13);
-
-    bnav::NavBits<13> iono { bits.getLeft<msb, msb_len>() };
-    iono <<= lsb_len;
-    // add lsb part to iono
-    bnav::NavBits<lsb_len> lsbits { bits.getLeft<lsb, lsb_len>() };
-    iono ^= lsbits;
-
-    return iono;
+    const uint32_t msb { lcl_getLeftBits(bits, field.msb, field.msb_len) };
+    return (msb << field.lsb_len) | lcl_getLeftBits(bits, field.lsb, field.lsb_len);
 }
+
 }
 
 namespace bnav
@@ -189,6 +122,23 @@ std::uint32_t IonoGridDimension::getItemCountLongitude() const
     return static_cast<std::uint32_t>(std::fabs((longitude_west - longitude_east) / longitude_spacing) + 0.5) + 1;
 }
 
+/**
+ * @brief getKlobucharGridDimension Get the grid of a Klobuchar model.
+ * @param global Global grid, else the one of the regional grid.
+ * @param latspacing Latitude spacing in degrees.
+ * @param longspacing Longitude spacing in degrees.
+ * @return Grid dimension, from north to south and west to east.
+ */
+IonoGridDimension getKlobucharGridDimension(const bool global, const double latspacing, const double longspacing)
+{
+    assert(latspacing > 0.0 && longspacing > 0.0);
+
+    if (global)
+        return IonoGridDimension(87.5, -87.5, -latspacing, -180.0, 180.0, longspacing);
+    else
+        return IonoGridDimension(55.0, 7.5, -latspacing, 70.0, 145.0, longspacing);
+}
+
 /**
  * @brief The Ionosphere class
  *
@@ -198,6 +148,7 @@ Ionosphere::Ionosphere()
     : m_datetime()
     , m_grid()
     , m_griddim()
+    , m_klobuchar()
 {
 }
 
@@ -220,31 +171,11 @@ void Ionosphere::load(const KlobucharParam &klob, const DateTime &datetime, cons
 
     // set model time in BDT
     m_datetime = datetime;
+    m_griddim = getKlobucharGridDimension(global);
+    m_klobuchar = klob;
 
-    if (global)
-        m_griddim = IonoGridDimension(87.5, -87.5, -2.5, -180.0, 180.0, 5.0);
-    else
-        m_griddim = IonoGridDimension(55.0, 7.5, -2.5, 70.0, 145.0, 5.0);
-
-    std::size_t rowcount = m_griddim.getItemCountLatitude();
-    std::size_t colcount = m_griddim.getItemCountLongitude();
-    std::cout << "rows: " << rowcount << " cols: " << colcount << std::endl;
-
-    for (std::size_t row = 0; row < rowcount; ++row)
-    {
-        // we use a single row vector for m_grid
-        for (std::size_t col = 0; col < colcount; ++col)
-        {
-            /// 1.0, because we are east of Greenwich
-            double lambda { 1.0 * (m_griddim.longitude_west + static_cast<double>(col) * 5.0) };
-            double phi { 1.0 * (m_griddim.latitude_north - static_cast<double>(row) * 2.5) };
-            //std::cout << "phi: " << phi << std::endl;
-            double corr { lcl_calcKlobucharCorrectionBDS(klob, secofday, phi, lambda) };
-            IonoGridInfo info;
-            info.loadFromMeter(corr);
-            m_grid.push_back(info);
-        }
-    }
+    // keep storage of a recycled model
+    KlobucharEvaluator(klob).evaluate(m_griddim, secofday, m_grid);
 
     if (global)
         assert(m_grid.size() == 5183);
@@ -255,99 +186,84 @@ void Ionosphere::load(const KlobucharParam &klob, const DateTime &datetime, cons
 void Ionosphere::load(const SubframeBufferParam &sfbuf, const uint32_t weeknum)
 {
     // ensure correct type
-    assert(sfbuf.type == SubframeBufferType::D2_ALMANAC);
-    // ensure there is one subframe
-    assert(sfbuf.data.size() == 1);
+    assert(sfbuf.type == SubframeBufferType::D2_ALMANAC
+           || sfbuf.type == SubframeBufferType::D2_IONOSPHERE);
 
-    SubframeVector vfra5 = sfbuf.data[0];
-    // ensure there are all pages
-    assert(vfra5.size() == 120);
+    m_klobuchar = boost::none;
 
-    // store grid data into single column vector with 320 elements
-    std::vector<IonoGridInfo> grid_chinese;
+    SubframeSpan igpblock[2];
+    if (sfbuf.type == SubframeBufferType::D2_ALMANAC)
+    {
+        // ensure there is one subframe
+        assert(sfbuf.framecount == 1);
 
-    // Pnum 1 to 13 of Frame 5
-    processPageBlock(vfra5, 0, grid_chinese);
-    // ensure we have all IGPs
-    assert(grid_chinese.size() == 160);
+        const SubframeSpan &vfra5 = sfbuf.data[0];
+        // ensure there are all pages
+        assert(vfra5.size() == 120);
 
+        // Pnum 1 to 13 and 61 to 73 of Frame 5
+        for (std::size_t block = 0; block <= 1; ++block)
+            igpblock[block] = SubframeSpan(vfra5.begin() + D2_IONOSPHERE_BLOCK_FIRSTPAGE[block] - 1,
+                                           D2_IONOSPHERE_BLOCK_SIZE);
+    }
+    else
+    {
+        // both IGP blocks only
+        assert(sfbuf.framecount == 2);
+
+        igpblock[0] = sfbuf.data[0];
+        igpblock[1] = sfbuf.data[1];
+    }
+
+    // every IGP is decoded straight into its european cell
+    m_grid.resize(2 * IGP_TABLE_SIZE);
+
+    // Pnum 1 to 13 of Frame 5
+    decodePageBlock(igpblock[0], 0);
     // Pnum 61 to 73 of Frame 5
-    processPageBlock(vfra5, 60, grid_chinese);
-    // ensure we have all IGPs
-    assert(grid_chinese.size() == 320);
+    decodePageBlock(igpblock[1], 1);
 
-    m_grid = lcl_convertChineseToEuropeanGrid(grid_chinese);
     m_griddim = IonoGridDimension(55.0, 7.5, -2.5, 70.0, 145.0, 5.0);
 
     // date of issue of ionospheric model is at page 1 of subframe 1
     // [1] 5.3.3.1 Basic NAV Information, p. 68
     // This gets it from subframe 5 page 1, which is ok, because for D2
     // subframes 1-5 have the same SOW.
-    m_datetime.setTimeSystem(TimeSystem::BDT);
-    m_datetime.setWeekAndSOW(weeknum, vfra5.front().getSOW());
+    m_datetime = DateTime(TimeSystem::BDT, weeknum, igpblock[0].front().getSOW());
 }
 
 /**
- * @brief Ionosphere::processPageBlock Process one block of ionospheric pages.
+ * @brief Ionosphere::decodePageBlock Decode one block of ionospheric pages.
  *
  * Both IGP tables are at separate page blocks: IGP<=160 is at pages 1 to 13
- * and IGP>160 is at 61 to 73.
+ * and IGP>160 is at 61 to 73. dt and givei are converted by lookup tables.
  *
- * @param vfra5 SubframeVector of all 120 pages of frame 5.
- * @param startpage Index where the block starts.
+ * @param block SubframeSpan of the 13 pages of one block.
+ * @param table 0 for IGP<=160, 1 for IGP>160.
  */
-void Ionosphere::processPageBlock(const SubframeVector &vfra5, const std::size_t startpage, std::vector<IonoGridInfo> &grid_chinese)
+void Ionosphere::decodePageBlock(const SubframeSpan &block, const std::size_t table)
 {
-    for (std::size_t i = startpage; i < startpage + 13; ++i)
-    {
-        uint32_t pnum { vfra5[i].getPageNum() };
-        assert(pnum == i + 1);
+    assert(block.size() == D2_IONOSPHERE_BLOCK_SIZE);
+    assert(m_grid.size() == 2 * IGP_TABLE_SIZE);
 
-        NavBits<300> bits { vfra5[i].getBits() };
+    const std::array<uint16_t, 512> &dttable = getVerticalDelayTable();
+    const std::array<uint16_t, 16> &giveitable = getGiveiTable();
 
-        // page 13 ash 73 have reserved bits at the end of message
-        parseIonospherePage(bits, pnum == 13 || pnum == 73, grid_chinese);
-    }
-}
+    for (std::size_t page = 0; page < block.size(); ++page)
+    {
+        assert(block[page].getPageNum() == D2_IONOSPHERE_BLOCK_FIRSTPAGE[table] + page);
 
-/**
- * @brief Ionosphere::parseIonospherePage Parse one page of ionospheric info.
- * @param bits message NavBits.
- * @param lastpage true, if this is page 13 or 73.
- */
-void Ionosphere::parseIonospherePage(const NavBits<300> &bits, const bool lastpage, std::vector<IonoGridInfo> &grid_chinese)
-{
-    // Ion1
-    grid_chinese.push_back(IonoGridInfo(lcl_parsePageIon<50, 2, 60, 11>(bits)));
-    // Ion2
-    grid_chinese.push_back(IonoGridInfo(lcl_parsePageIon<71, 11, 90, 2>(bits)));
-    // Ion3
-    grid_chinese.push_back(IonoGridInfo(bits.getLeft<92, 13>()));
-    // Ion4
-    grid_chinese.push_back(IonoGridInfo(lcl_parsePageIon<105, 7, 120, 6>(bits)));
-
-    // page 13 and 73 have no more data, bail out
-    if (lastpage)
-        return;
-
-    // Ion5
-    grid_chinese.push_back(IonoGridInfo(bits.getLeft<126, 13>()));
-    // Ion6
-    grid_chinese.push_back(IonoGridInfo(lcl_parsePageIon<139, 3, 150, 10>(bits)));
-    // Ion7
-    grid_chinese.push_back(IonoGridInfo(lcl_parsePageIon<160, 12, 180, 1>(bits)));
-    // Ion8
-    grid_chinese.push_back(IonoGridInfo(bits.getLeft<181, 13>()));
-    // Ion9
-    grid_chinese.push_back(IonoGridInfo(lcl_parsePageIon<194, 8, 210, 5>(bits)));
-    // Ion10
-    grid_chinese.push_back(IonoGridInfo(bits.getLeft<215, 13>()));
-    // Ion11
-    grid_chinese.push_back(IonoGridInfo(lcl_parsePageIon<228, 4, 240, 9>(bits)));
-    // Ion12
-    grid_chinese.push_back(IonoGridInfo(bits.getLeft<249, 13>()));
-    // Ion13
-    grid_chinese.push_back(IonoGridInfo(bits.getLeft<270, 13>()));
+        // page 13 and 73 have reserved bits at the end of message
+        const std::size_t ioncount { page + 1 == D2_IONOSPHERE_BLOCK_SIZE ? IONS_LAST_PAGE : IONS_PER_PAGE };
+        const NavBits<300> &bits = block[page].getBits();
+        for (std::size_t ion = 0; ion < ioncount; ++ion)
+        {
+            // first 9 bits are dt, last 4 bits are givei
+            const uint32_t raw { lcl_parsePageIon(bits, ION_FIELDS[ion]) };
+            const std::size_t igp { table * IGP_TABLE_SIZE + page * IONS_PER_PAGE + ion };
+            m_grid.set(lcl_getEuropeanIndex(igp), dttable[raw >> 4], giveitable[raw & 0xF]);
+        }
+    }
 }
 
 bool Ionosphere::hasData() const
@@ -374,22 +290,22 @@ DateTime Ionosphere::getDateOfIssue() const
 }
 
 /**
- * @brief getGrid Return the raw iono grid as single row vector.
- * @return vector of IonoGridInfo.
+ * @brief getGrid Return the raw iono grid as single row.
+ * @return IonoGrid, valid as long as the model is neither modified nor
+ * released.
  */
-std::vector<IonoGridInfo> Ionosphere::getGrid() const
+const IonoGrid& Ionosphere::getGrid() const
 {
     return m_grid;
 }
 
-void Ionosphere::setGrid(const std::vector<IonoGridInfo> &rhs)
+void Ionosphere::setGrid(const IonoGrid &rhs)
 {
-    // regional grid has 320 cells, global 5183
-    assert(rhs.size() == 320 || rhs.size() == 5183);
+    // regional grid has 320 cells, global 5183, grids at other spacings have
+    // to fit the grid dimension set before
+    assert(rhs.size() == 320 || rhs.size() == 5183 || rhs.size() == m_grid.size());
     // FIXME: should set m_griddim, too - or at least fit to it
-    m_grid.clear();
-    for (auto it = rhs.cbegin(); it != rhs.cend(); ++it)
-        m_grid.push_back(*it);
+    m_grid = rhs;
 }
 
 void Ionosphere::setGridDimension(const IonoGridDimension &igd)
@@ -407,21 +323,35 @@ IonoGridDimension Ionosphere::getGridDimension() const
     return m_griddim;
 }
 
+/**
+ * @brief Ionosphere::setKlobucharParam Set the parameters of a Klobuchar
+ * model, the grid is left as it is.
+ * @param klob Parameters, none for a regional grid.
+ */
+void Ionosphere::setKlobucharParam(const boost::optional<KlobucharParam> &klob)
+{
+    m_klobuchar = klob;
+}
+
+/**
+ * @brief Ionosphere::getKlobucharParam Get the parameters of a Klobuchar
+ * model, so it can be evaluated at any grid and time.
+ * @return Parameters, none for a regional grid.
+ */
+boost::optional<KlobucharParam> Ionosphere::getKlobucharParam() const
+{
+    return m_klobuchar;
+}
+
 Ionosphere Ionosphere::diffToModel(const Ionosphere &rhs)
 {
     Ionosphere diff;
-    std::vector<IonoGridInfo> vdiff;
-    const std::vector<IonoGridInfo> gridrhs = rhs.getGrid();
-    assert(m_grid.size() == gridrhs.size());
+    assert(m_grid.size() == rhs.m_grid.size());
 
     // use SOW from current Ionosphere
     diff.setDateOfIssue(m_datetime);
 
-    for (std::size_t i = 0; i < m_grid.size(); ++i)
-    {
-        vdiff.push_back(m_grid[i] - gridrhs[i]);
-    }
-    diff.setGrid(vdiff);
+    diff.setGrid(m_grid - rhs.m_grid);
     diff.setGridDimension(getGridDimension());
 
     return diff;
@@ -434,8 +364,8 @@ Ionosphere Ionosphere::diffToModel(const Ionosphere &rhs)
  */
 bool Ionosphere::operator==(const Ionosphere &iono) const
 {
-    assert(iono.getGrid().size() == m_grid.size());
-    return (iono.getGrid() == m_grid);
+    assert(iono.m_grid.size() == m_grid.size());
+    return (iono.m_grid == m_grid);
 }
 
 /**
@@ -457,7 +387,7 @@ void Ionosphere::dump(const bool rms) const
         for (std::size_t col = 0; col < colcount; ++col)
         {
             std::cout << std::setw(5)
-                      << (rms ? m_grid[index].getGive_TECU() : m_grid[index].getVerticalDelay_TECU());
+                      << (rms ? m_grid.getGive_TECU(index) : m_grid.getVerticalDelay_TECU(index));
             ++index;
         }
         std::cout << std::endl;
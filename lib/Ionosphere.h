@@ -6,10 +6,15 @@
 #include "DateTime.h"
 
 #include "Ephemeris.h"
+#include "IonosphereGrid.h"
 #include "IonosphereGridInfo.h"
 
+#include <array>
+#include <cassert>
 #include <vector>
 
+#include <boost/optional.hpp>
+
 namespace bnav
 {
 
@@ -30,11 +35,14 @@ struct IonoGridDimension
     std::uint32_t getItemCountLongitude() const;
 };
 
+IonoGridDimension getKlobucharGridDimension(const bool global, const double latspacing = 2.5, const double longspacing = 5.0);
+
 class Ionosphere
 {
     DateTime m_datetime;
-    std::vector<IonoGridInfo> m_grid;
+    IonoGrid m_grid;
     IonoGridDimension m_griddim;
+    boost::optional<KlobucharParam> m_klobuchar; ///< parameters of a Klobuchar model
 
 public:
     Ionosphere();
@@ -48,12 +56,15 @@ public:
     void setDateOfIssue(const DateTime &datetime);
     DateTime getDateOfIssue() const;
 
-    void setGrid(const std::vector<IonoGridInfo> &rhs);
-    std::vector<IonoGridInfo> getGrid() const;
+    void setGrid(const IonoGrid &rhs);
+    const IonoGrid& getGrid() const;
 
     void setGridDimension(const IonoGridDimension &igd);
     IonoGridDimension getGridDimension() const;
 
+    void setKlobucharParam(const boost::optional<KlobucharParam> &klob);
+    boost::optional<KlobucharParam> getKlobucharParam() const;
+
     Ionosphere diffToModel(const Ionosphere &rhs);
 
     bool operator==(const Ionosphere &iono) const;
@@ -61,8 +72,7 @@ public:
     void dump(const bool rms = false) const;
 
 private:
-    void processPageBlock(const SubframeVector &vfra5, const std::size_t startpage, std::vector<IonoGridInfo> &grid_chinese);
-    void parseIonospherePage(const NavBits<300> &bits, const bool lastpage, std::vector<IonoGridInfo> &grid_chinese);
+    void decodePageBlock(const SubframeSpan &block, const std::size_t table);
 };
 
 } // namespace bnav
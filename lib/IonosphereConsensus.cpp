@@ -0,0 +1,145 @@
+#include "IonosphereConsensus.h"
+
+#include <iostream>
+#include <utility>
+
+namespace bnav
+{
+
+IonosphereConsensus::IonosphereConsensus()
+    : m_epochs()
+    , m_items()
+    , m_copyCount(0)
+    , m_conflictCount(0)
+{
+}
+
+/**
+ * @brief IonosphereConsensus::addIonosphere Add the model of one SV.
+ * @param sv The SvID.
+ * @param iono The model, moved into the consensus if taken.
+ * @return true, if the model was taken. false, if it's a copy of a kept one,
+ * its storage may be reused then.
+ */
+bool IonosphereConsensus::addIonosphere(const SvID &sv, Ionosphere &iono)
+{
+    const DateTime dt { iono.getDateOfIssue() };
+    const std::size_t index { m_items.find(dt) };
+    if (index == m_items.size())
+    {
+        m_epochs.insert(dt, Epoch { { Candidate { Ionosphere(), sv, 1 } }, 0 });
+        m_items.insert(dt, std::move(iono));
+        return true;
+    }
+
+    Epoch &epoch = m_epochs[index];
+    Ionosphere &item = m_items[index];
+    for (std::size_t i = 0; i < epoch.candidates.size(); ++i)
+    {
+        Candidate &candidate = epoch.candidates[i];
+        const Ionosphere &model = i == epoch.winner ? item : candidate.iono;
+        if (model == iono)
+        {
+            ++m_copyCount;
+            ++candidate.votes;
+            if (sv.getPRN() < candidate.sv.getPRN())
+                candidate.sv = sv;
+            updateWinner(epoch, item);
+            return false;
+        }
+    }
+
+    std::cout << "Consensus conflict at " << dt.getDateTimeString()
+              << " for SV: " << sv.getPRN() << std::endl;
+    ++m_conflictCount;
+
+    epoch.candidates.push_back(Candidate { std::move(iono), sv, 1 });
+    updateWinner(epoch, item);
+    return true;
+}
+
+/**
+ * @brief IonosphereConsensus::recycle Move all models into a pool.
+ * @param pool Pool, which takes the models.
+ */
+void IonosphereConsensus::recycle(IonospherePool &pool)
+{
+    for (Ionosphere &item : m_items)
+        pool.release(std::move(item));
+    m_items.clear();
+
+    for (Epoch &epoch : m_epochs)
+    {
+        for (Candidate &candidate : epoch.candidates)
+        {
+            if (candidate.iono.hasData())
+                pool.release(std::move(candidate.iono));
+        }
+    }
+    m_epochs.clear();
+}
+
+bool IonosphereConsensus::empty() const
+{
+    return m_items.empty();
+}
+
+/**
+ * @brief IonosphereConsensus::getItems Get the winning model of each epoch.
+ * @return Models by date of issue, valid until the next change.
+ */
+const TimeSeries<Ionosphere>& IonosphereConsensus::getItems() const
+{
+    return m_items;
+}
+
+/**
+ * @brief IonosphereConsensus::updateWinner Move the model of the winner of an
+ * epoch into the items.
+ * @param epoch The epoch.
+ * @param item Item of the epoch, the model of the last winner.
+ */
+void IonosphereConsensus::updateWinner(Epoch &epoch, Ionosphere &item)
+{
+    std::size_t winner = epoch.winner;
+    for (std::size_t i = 0; i < epoch.candidates.size(); ++i)
+    {
+        const Candidate &candidate = epoch.candidates[i];
+        const Candidate &best = epoch.candidates[winner];
+        if (candidate.votes > best.votes
+                || (candidate.votes == best.votes && candidate.sv.getPRN() < best.sv.getPRN()))
+            winner = i;
+    }
+
+    if (winner == epoch.winner)
+        return;
+
+    // the old winner is a candidate again, the new one leaves an empty model
+    std::swap(item, epoch.candidates[epoch.winner].iono);
+    std::swap(item, epoch.candidates[winner].iono);
+    epoch.winner = winner;
+}
+
+std::size_t IonosphereConsensus::getEpochCount() const
+{
+    return m_epochs.size();
+}
+
+std::size_t IonosphereConsensus::getCopyCount() const
+{
+    return m_copyCount;
+}
+
+std::size_t IonosphereConsensus::getConflictCount() const
+{
+    return m_conflictCount;
+}
+
+void IonosphereConsensus::dump(const std::string &name) const
+{
+    std::cout << "IonosphereConsensus statistics: " << name << std::endl;
+    std::cout << m_items.size() << " epochs, " << m_copyCount << " copies, "
+              << m_conflictCount << " conflicts" << std::endl;
+}
+
+} // namespace bnav
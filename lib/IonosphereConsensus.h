@@ -0,0 +1,73 @@
+#ifndef IONOSPHERECONSENSUS_H
+#define IONOSPHERECONSENSUS_H
+
+#include "Ionosphere.h"
+#include "IonospherePool.h"
+#include "DateTime.h"
+#include "SvID.h"
+#include "TimeSeriesStore.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The IonosphereConsensus class
+ *
+ * Fuses the models of several SVs, which broadcast the same product, into one
+ * product. All GEOs broadcast the same Klobuchar parameters and the same
+ * regional grid, so an epoch missed by one GEO is filled by another.
+ *
+ * The first copy of an epoch is kept, further copies are only compared with
+ * it. A copy, which differs, is kept as another candidate. Of conflicting
+ * candidates the one of most SVs wins, on a tie the one with the lowest PRN,
+ * so the result does not depend on the order of the copies.
+ *
+ * The winner of each epoch is kept in a series of its own, so the product is
+ * read without copying any model.
+ */
+class IonosphereConsensus
+{
+    struct Candidate
+    {
+        Ionosphere iono; ///< empty for the winner
+        SvID sv; ///< lowest PRN of all copies
+        std::size_t votes;
+    };
+
+    struct Epoch
+    {
+        std::vector<Candidate> candidates;
+        std::size_t winner;
+    };
+
+    TimeSeries<Epoch> m_epochs;
+    TimeSeries<Ionosphere> m_items; ///< model of the winner of each epoch, same index as in m_epochs
+    std::size_t m_copyCount;
+    std::size_t m_conflictCount;
+
+public:
+    IonosphereConsensus();
+
+    bool addIonosphere(const SvID &sv, Ionosphere &iono);
+    void recycle(IonospherePool &pool);
+
+    bool empty() const;
+    const TimeSeries<Ionosphere>& getItems() const;
+
+    std::size_t getEpochCount() const;
+    std::size_t getCopyCount() const;
+    std::size_t getConflictCount() const;
+
+    void dump(const std::string &name) const;
+
+private:
+    void updateWinner(Epoch &epoch, Ionosphere &item);
+};
+
+} // namespace bnav
+
+#endif // IONOSPHERECONSENSUS_H
@@ -0,0 +1,182 @@
+#include "IonosphereGrid.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+
+/**
+ * @brief lcl_toCell Convert a value of IonoGridInfo into a cell value.
+ * @param value TECU value, maximum of uint32_t if not set.
+ * @return Cell value.
+ */
+uint16_t lcl_toCell(const uint32_t value)
+{
+    if (value == std::numeric_limits<uint32_t>::max())
+        return bnav::IonoGrid::IONOGRID_UNSET;
+
+    assert(value < bnav::IonoGrid::IONOGRID_UNSET);
+    return static_cast<uint16_t>(value);
+}
+
+uint32_t lcl_fromCell(const uint16_t value)
+{
+    return value == bnav::IonoGrid::IONOGRID_UNSET ? std::numeric_limits<uint32_t>::max() : value;
+}
+
+/**
+ * @brief lcl_diffAbsTECUValues Absolute difference between two cell values.
+ * @return Invalid 9999, if one of both is invalid, unset if one of both is
+ * unset, otherwise absolute difference.
+ */
+uint16_t lcl_diffAbsTECUValues(const uint16_t t1, const uint16_t t2)
+{
+    if (t1 == bnav::IonoGrid::IONOGRID_UNSET || t2 == bnav::IonoGrid::IONOGRID_UNSET)
+        return bnav::IonoGrid::IONOGRID_UNSET;
+    if (t1 == 9999 || t2 == 9999)
+        return 9999;
+
+    return static_cast<uint16_t>(t1 > t2 ? t1 - t2 : t2 - t1);
+}
+
+}
+
+namespace bnav
+{
+
+constexpr uint16_t IonoGrid::IONOGRID_UNSET;
+
+IonoGrid::IonoGrid()
+    : m_dt()
+    , m_give()
+{
+}
+
+/**
+ * @brief IonoGrid::IonoGrid Grid with all cells set to one value.
+ * @param size Cell count.
+ * @param info Value of all cells, unset by default.
+ */
+IonoGrid::IonoGrid(const std::size_t size, const IonoGridInfo &info)
+    : IonoGrid()
+{
+    assign(size, info);
+}
+
+/**
+ * @brief IonoGrid::IonoGrid Convert a grid of IonoGridInfo.
+ * @param grid The grid.
+ */
+IonoGrid::IonoGrid(const std::vector<IonoGridInfo> &grid)
+    : IonoGrid()
+{
+    reserve(grid.size());
+    for (const IonoGridInfo &info : grid)
+        push_back(info);
+}
+
+/// Remove all cells, keep the storage
+void IonoGrid::clear()
+{
+    m_dt.clear();
+    m_give.clear();
+}
+
+void IonoGrid::reserve(const std::size_t size)
+{
+    m_dt.reserve(size);
+    m_give.reserve(size);
+}
+
+/// Resize, new cells are unset
+void IonoGrid::resize(const std::size_t size)
+{
+    m_dt.resize(size, IONOGRID_UNSET);
+    m_give.resize(size, IONOGRID_UNSET);
+}
+
+void IonoGrid::assign(const std::size_t size, const IonoGridInfo &info)
+{
+    m_dt.assign(size, info.isValid() ? lcl_toCell(info.getVerticalDelay_TECU()) : IONOGRID_UNSET);
+    m_give.assign(size, info.isValid() ? lcl_toCell(info.getGive_TECU()) : IONOGRID_UNSET);
+}
+
+/**
+ * @brief IonoGrid::assign Copy raw cells, e.g. of getVerticalDelayData().
+ * @param dt Vertical delays of all cells.
+ * @param give GIVE of all cells.
+ * @param size Cell count.
+ */
+void IonoGrid::assign(const uint16_t *dt, const uint16_t *give, const std::size_t size)
+{
+    m_dt.assign(dt, dt + size);
+    m_give.assign(give, give + size);
+}
+
+void IonoGrid::push_back(const IonoGridInfo &info)
+{
+    m_dt.push_back(info.isValid() ? lcl_toCell(info.getVerticalDelay_TECU()) : IONOGRID_UNSET);
+    m_give.push_back(info.isValid() ? lcl_toCell(info.getGive_TECU()) : IONOGRID_UNSET);
+}
+
+void IonoGrid::set(const std::size_t index, const IonoGridInfo &info)
+{
+    assert(index < size());
+    m_dt[index] = info.isValid() ? lcl_toCell(info.getVerticalDelay_TECU()) : IONOGRID_UNSET;
+    m_give[index] = info.isValid() ? lcl_toCell(info.getGive_TECU()) : IONOGRID_UNSET;
+}
+
+/**
+ * @brief IonoGrid::operator[] Get one cell.
+ * @param index Index of the cell.
+ * @return The cell, not valid if unset.
+ */
+IonoGridInfo IonoGrid::operator[](const std::size_t index) const
+{
+    assert(index < size());
+    if (m_dt[index] == IONOGRID_UNSET)
+        return IonoGridInfo();
+
+    return IonoGridInfo(m_dt[index], lcl_fromCell(m_give[index]));
+}
+
+/**
+ * @brief IonoGrid::setVerticalDelay_TECU Set the vertical delay of a cell,
+ * same as IonoGridInfo::setVerticalDelay_TECU().
+ */
+void IonoGrid::setVerticalDelay_TECU(const std::size_t index, const uint32_t tec)
+{
+    assert(index < size());
+    assert(tec < 10000);
+    m_dt[index] = static_cast<uint16_t>(tec);
+}
+
+/**
+ * @brief IonoGrid::operator- Absolute difference of each cell, see
+ * IonoGridInfo::operator-().
+ * @param rhs Grid of the same size.
+ * @return Difference grid.
+ */
+IonoGrid IonoGrid::operator-(const IonoGrid &rhs) const
+{
+    assert(size() == rhs.size());
+
+    IonoGrid diff;
+    diff.resize(size());
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        assert(m_dt[i] != IONOGRID_UNSET && rhs.m_dt[i] != IONOGRID_UNSET);
+        diff.m_dt[i] = lcl_diffAbsTECUValues(m_dt[i], rhs.m_dt[i]);
+        diff.m_give[i] = lcl_diffAbsTECUValues(m_give[i], rhs.m_give[i]);
+    }
+
+    return diff;
+}
+
+bool IonoGrid::operator==(const IonoGrid &rhs) const
+{
+    return m_dt == rhs.m_dt && m_give == rhs.m_give;
+}
+
+} // namespace bnav
@@ -0,0 +1,77 @@
+#ifndef IONOSPHEREGRID_H
+#define IONOSPHEREGRID_H
+
+#include "IonosphereGridInfo.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The IonoGrid class
+ *
+ * Grid of IGPs, stored as separate arrays of vertical delay and GIVE in 0.1
+ * TECU. Both fit into 16 bits, a cell takes 4 bytes instead of the 12 bytes
+ * of an IonoGridInfo. A cell, which was never set, holds IONOGRID_UNSET.
+ */
+class IonoGrid
+{
+    std::vector<uint16_t> m_dt;
+    std::vector<uint16_t> m_give;
+
+public:
+    /// sentinel of a cell without value, 9999 is a value (not available)
+    static constexpr uint16_t IONOGRID_UNSET = 0xFFFF;
+
+    IonoGrid();
+    IonoGrid(const std::size_t size, const IonoGridInfo &info = IonoGridInfo());
+    IonoGrid(const std::vector<IonoGridInfo> &grid);
+
+    std::size_t size() const { return m_dt.size(); }
+    bool empty() const { return m_dt.empty(); }
+
+    void clear();
+    void reserve(const std::size_t size);
+    void resize(const std::size_t size);
+    void assign(const std::size_t size, const IonoGridInfo &info);
+    void assign(const uint16_t *dt, const uint16_t *give, const std::size_t size);
+
+    void push_back(const IonoGridInfo &info);
+    void set(const std::size_t index, const IonoGridInfo &info);
+
+    void set(const std::size_t index, const uint16_t dt, const uint16_t give)
+    {
+        assert(index < m_dt.size());
+        m_dt[index] = dt;
+        m_give[index] = give;
+    }
+
+    IonoGridInfo operator[](const std::size_t index) const;
+
+    uint16_t getVerticalDelay_TECU(const std::size_t index) const
+    {
+        assert(index < m_dt.size() && m_dt[index] != IONOGRID_UNSET);
+        return m_dt[index];
+    }
+
+    uint16_t getGive_TECU(const std::size_t index) const
+    {
+        assert(index < m_give.size() && m_dt[index] != IONOGRID_UNSET);
+        return m_give[index];
+    }
+
+    void setVerticalDelay_TECU(const std::size_t index, const uint32_t tec);
+
+    const uint16_t* getVerticalDelayData() const { return m_dt.data(); }
+    const uint16_t* getGiveData() const { return m_give.data(); }
+
+    IonoGrid operator-(const IonoGrid &rhs) const;
+    bool operator==(const IonoGrid &rhs) const;
+};
+
+} // namespace bnav
+
+#endif // IONOSPHEREGRID_H
@@ -42,11 +42,52 @@ uint32_t lcl_diffAbsTECUValues(const uint32_t t1, const uint32_t t2)
         return t1 - t2;
 }
 
+std::array<uint16_t, 512> lcl_buildVerticalDelayTable()
+{
+    std::array<uint16_t, 512> table;
+    for (uint32_t dtraw = 0; dtraw < table.size(); ++dtraw)
+    {
+        // 510 and 511 mark a not available IGP
+        if (dtraw >= 510)
+            table[dtraw] = 9999;
+        else
+            table[dtraw] = static_cast<uint16_t>(lcl_convertMeterToTECU(dtraw * 0.125, bnav::BDS_B1I_FREQ));
+    }
+    return table;
+}
+
+std::array<uint16_t, 16> lcl_buildGiveiTable()
+{
+    std::array<uint16_t, 16> table;
+    for (uint32_t givei = 0; givei < table.size(); ++givei)
+    {
+        // according to the ICD there are no invalid values, but invalid dt
+        // values get GIVEI 15, so set this to invalid, too
+        if (givei == 15)
+            table[givei] = 9999;
+        else
+            table[givei] = static_cast<uint16_t>(lcl_convertMeterToTECU(GIVEI_LOOKUP_TABLE[givei], bnav::BDS_B1I_FREQ));
+    }
+    return table;
+}
+
 }
 
 namespace bnav
 {
 
+const std::array<uint16_t, 512>& getVerticalDelayTable()
+{
+    static const std::array<uint16_t, 512> table { lcl_buildVerticalDelayTable() };
+    return table;
+}
+
+const std::array<uint16_t, 16>& getGiveiTable()
+{
+    static const std::array<uint16_t, 16> table { lcl_buildGiveiTable() };
+    return table;
+}
+
 /**
  * @brief The IonoGridInfo class
  *
@@ -105,15 +146,8 @@ void IonoGridInfo::loadVerticalDelay(const NavBits<9> &bits)
     uint32_t dtraw { bits.to_uint32_t() };
     // maximum value is 63.875m, which is 511 when scaled by 0.125
     assert(dtraw <= 511);
-    // convert to TECU
-    if (dtraw >= 510)
-        m_dtTECU =  9999;
-    else
-    {
-        // metric
-        double dt { dtraw * 0.125 };
-        m_dtTECU = lcl_convertMeterToTECU(dt, BDS_B1I_FREQ);
-    }
+    // converted to TECU, scaled by 0.125 to meters
+    m_dtTECU = getVerticalDelayTable()[dtraw];
 }
 
 void IonoGridInfo::loadGivei(const NavBits<4> &bits)
@@ -121,12 +155,7 @@ void IonoGridInfo::loadGivei(const NavBits<4> &bits)
     uint32_t givei { bits.to_uint32_t() };
     assert(givei <= 15);
 
-    // according to the ICD there are no invalid values, but invalid dt values
-    // get GIVEI 15, so set this to invalid, too
-    if (givei == 15)
-        m_giveTECU = 9999;
-    else
-        m_giveTECU = lcl_convertMeterToTECU(GIVEI_LOOKUP_TABLE[givei], BDS_B1I_FREQ);
+    m_giveTECU = getGiveiTable()[givei];
 }
 
 void IonoGridInfo::setVerticalDelay_TECU(const uint32_t tec)
@@ -156,6 +185,15 @@ uint32_t IonoGridInfo::getGive_TECU() const
     return m_giveTECU;
 }
 
+/**
+ * @brief IonoGridInfo::isValid Whether a value was loaded.
+ * @return true, if loaded. A not available value (9999) is valid, too.
+ */
+bool IonoGridInfo::isValid() const
+{
+    return m_isValid;
+}
+
 bool IonoGridInfo::operator==(const IonoGridInfo &rhs) const
 {
     assert(m_isValid);
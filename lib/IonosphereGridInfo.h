@@ -3,11 +3,17 @@
 
 #include "NavBits.h"
 
+#include <array>
 #include <cstdint>
 
 namespace bnav
 {
 
+/// 0.1 TECU of each raw 9 bit vertical delay, 9999 if not available
+const std::array<uint16_t, 512>& getVerticalDelayTable();
+/// 0.1 TECU of each 4 bit GIVEI, 9999 if not available
+const std::array<uint16_t, 16>& getGiveiTable();
+
 class IonoGridInfo
 {
      uint32_t m_dtTECU; ///< dt converted to 0.1 TECU
@@ -28,6 +34,8 @@ public:
      uint32_t getVerticalDelay_TECU() const;
      uint32_t getGive_TECU() const;
 
+     bool isValid() const;
+
      bool operator==(const IonoGridInfo &rhs) const;
      IonoGridInfo operator-(const IonoGridInfo &rhs) const;
 
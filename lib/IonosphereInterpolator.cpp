@@ -0,0 +1,264 @@
+#include "IonosphereInterpolator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+
+/// delay of an unavailable query
+constexpr double UNAVAILABLE_DELAY = 9999.0;
+
+bool lcl_isClose(const double lhs, const double rhs)
+{
+    return std::fabs(lhs - rhs) < 1.0e-9;
+}
+
+bool lcl_isSameDimension(const bnav::IonoGridDimension &lhs, const bnav::IonoGridDimension &rhs)
+{
+    return lcl_isClose(lhs.latitude_north, rhs.latitude_north)
+           && lcl_isClose(lhs.latitude_south, rhs.latitude_south)
+           && lcl_isClose(lhs.latitude_spacing, rhs.latitude_spacing)
+           && lcl_isClose(lhs.longitude_west, rhs.longitude_west)
+           && lcl_isClose(lhs.longitude_east, rhs.longitude_east)
+           && lcl_isClose(lhs.longitude_spacing, rhs.longitude_spacing);
+}
+
+}
+
+namespace bnav
+{
+
+/**
+ * @brief IonosphereInterpolator::IonosphereInterpolator
+ * @param maxgap Maximum time between two grids, which are interpolated [s].
+ */
+IonosphereInterpolator::IonosphereInterpolator(const std::uint32_t maxgap)
+    : m_griddim()
+    , m_rowcount(0)
+    , m_colcount(0)
+    , m_maxgap(maxgap)
+    , m_epochs()
+    , m_cells()
+{
+}
+
+/**
+ * @brief IonosphereInterpolator::IonosphereInterpolator
+ * @param items Grids by date of issue, e.g. of IonosphereStore::getItemsBySv().
+ * @param maxgap Maximum time between two grids, which are interpolated [s].
+ */
+IonosphereInterpolator::IonosphereInterpolator(const TimeSeries<Ionosphere> &items, const std::uint32_t maxgap)
+    : IonosphereInterpolator(maxgap)
+{
+    for (const Ionosphere &iono : items)
+        addIonosphere(iono);
+}
+
+/**
+ * @brief IonosphereInterpolator::addIonosphere Add the grid of one epoch, a
+ * grid of the same epoch is replaced.
+ * @param iono The model, of the same grid dimension as all others.
+ */
+void IonosphereInterpolator::addIonosphere(const Ionosphere &iono)
+{
+    assert(iono.hasData());
+
+    if (m_epochs.empty())
+    {
+        m_griddim = iono.getGridDimension();
+        m_rowcount = m_griddim.getItemCountLatitude();
+        m_colcount = m_griddim.getItemCountLongitude();
+        assert(m_rowcount > 1 && m_colcount > 1);
+    }
+    assert(lcl_isSameDimension(m_griddim, iono.getGridDimension()));
+
+    Epoch epoch;
+    epoch.time = getTime(iono.getDateOfIssue());
+
+    const IonoGrid &grid = iono.getGrid();
+    assert(grid.size() == m_rowcount * m_colcount);
+    epoch.value.reserve(grid.size());
+    epoch.valid.reserve(grid.size());
+    for (std::size_t i = 0; i < grid.size(); ++i)
+    {
+        const uint16_t dt { grid.getVerticalDelay_TECU(i) };
+        epoch.value.push_back(dt != 9999 ? dt : 0.0);
+        epoch.valid.push_back(dt != 9999 ? 1.0 : 0.0);
+    }
+
+    auto it = std::lower_bound(m_epochs.begin(), m_epochs.end(), epoch.time,
+                               [](const Epoch &lhs, const double time) { return lhs.time < time; });
+    // times are whole seconds, it->time is not before epoch.time
+    if (it != m_epochs.end() && !(epoch.time < it->time))
+        *it = std::move(epoch);
+    else
+        m_epochs.insert(it, std::move(epoch));
+}
+
+bool IonosphereInterpolator::empty() const
+{
+    return m_epochs.empty();
+}
+
+/**
+ * @brief IonosphereInterpolator::getTime Get the time of a query.
+ * @param datetime Time in BDT.
+ * @return Seconds since the begin of BDT week 0.
+ */
+double IonosphereInterpolator::getTime(const DateTime &datetime)
+{
+    return static_cast<double>(datetime.getWeekNum()) * SECONDS_OF_A_WEEK + datetime.getSOW();
+}
+
+/**
+ * @brief IonosphereInterpolator::evaluate Evaluate a batch of queries.
+ *
+ * Queries in time order are fastest, the grids around a query are looked up
+ * only, if it's not in the interval of the query before.
+ *
+ * @param latitude Latitude of each pierce point [deg].
+ * @param longitude Longitude of each pierce point [deg].
+ * @param time Time of each query, see getTime().
+ * @param delay Vertical delay at each pierce point [0.1 TECU], 9999 if not
+ * available.
+ * @return Count of available delays.
+ */
+std::size_t IonosphereInterpolator::evaluate(const std::vector<double> &latitude, const std::vector<double> &longitude,
+                                             const std::vector<double> &time, std::vector<double> &delay)
+{
+    assert(latitude.size() == longitude.size() && latitude.size() == time.size());
+
+    const std::size_t querycount { latitude.size() };
+    delay.assign(querycount, UNAVAILABLE_DELAY);
+    if (m_epochs.empty())
+        return 0;
+
+    locateCells(latitude, longitude);
+
+    std::size_t count = 0;
+    // epochs of the last query
+    auto next = m_epochs.end();
+    for (std::size_t i = 0; i < querycount; ++i)
+    {
+        const double t { time[i] };
+        const bool isSameInterval { next != m_epochs.end() && t < next->time
+                                    && (next == m_epochs.begin() || !(t < std::prev(next)->time)) };
+        if (!isSameInterval)
+            next = std::upper_bound(m_epochs.begin(), m_epochs.end(), t,
+                                    [](const double querytime, const Epoch &rhs) { return querytime < rhs.time; });
+
+        // before the first grid
+        if (next == m_epochs.begin())
+            continue;
+
+        // before.time is not after t
+        const Epoch &before = *std::prev(next);
+        double value { 0.0 };
+        bool isAvailable { false };
+        if (!(before.time < t))
+        {
+            isAvailable = interpolate(before, i, value);
+        }
+        else if (next != m_epochs.end() && next->time - before.time <= m_maxgap)
+        {
+            double v0 { 0.0 }, v1 { 0.0 };
+            isAvailable = interpolate(before, i, v0) && interpolate(*next, i, v1);
+            if (isAvailable)
+                value = v0 + (v1 - v0) * (t - before.time) / (next->time - before.time);
+        }
+
+        if (isAvailable)
+        {
+            delay[i] = value;
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief IonosphereInterpolator::locateCells Get the grid cell and the offset
+ * in it of each query.
+ *
+ * Branch free, so the compiler vectorizes it. A pierce point on the south or
+ * east border gets the cell before with offset 1.
+ */
+void IonosphereInterpolator::locateCells(const std::vector<double> &latitude, const std::vector<double> &longitude)
+{
+    const std::size_t querycount { latitude.size() };
+    m_cells.index.resize(querycount);
+    m_cells.x.resize(querycount);
+    m_cells.y.resize(querycount);
+    m_cells.inside.resize(querycount);
+
+    const double lastrow { static_cast<double>(m_rowcount - 1) };
+    const double lastcol { static_cast<double>(m_colcount - 1) };
+    const double north { m_griddim.latitude_north };
+    const double west { m_griddim.longitude_west };
+    const double latspacing { m_griddim.latitude_spacing };
+    const double longspacing { m_griddim.longitude_spacing };
+    const std::uint32_t colcount { m_colcount };
+
+    const double *lat = latitude.data();
+    const double *lon = longitude.data();
+    std::uint32_t *index = m_cells.index.data();
+    double *x = m_cells.x.data();
+    double *y = m_cells.y.data();
+    double *inside = m_cells.inside.data();
+
+    for (std::size_t i = 0; i < querycount; ++i)
+    {
+        // east of the west border
+        double east { lon[i] - west };
+        east -= 360.0 * std::floor(east / 360.0);
+
+        const double row { (lat[i] - north) / latspacing };
+        const double col { east / longspacing };
+        const double cellrow { std::max(0.0, std::min(std::floor(row), lastrow - 1.0)) };
+        const double cellcol { std::max(0.0, std::min(std::floor(col), lastcol - 1.0)) };
+
+        index[i] = static_cast<std::uint32_t>(cellrow) * colcount + static_cast<std::uint32_t>(cellcol);
+        y[i] = row - cellrow;
+        x[i] = col - cellcol;
+        inside[i] = (row >= 0.0 && row <= lastrow && col <= lastcol) ? 1.0 : 0.0;
+    }
+}
+
+/**
+ * @brief IonosphereInterpolator::interpolate Interpolate the grid of one
+ * epoch at the cell of a query.
+ * @param epoch The grid.
+ * @param query Index of the query.
+ * @param value Delay [0.1 TECU].
+ * @return false, if not available.
+ */
+bool IonosphereInterpolator::interpolate(const Epoch &epoch, const std::size_t query, double &value) const
+{
+    const std::uint32_t nw { m_cells.index[query] };
+    const std::uint32_t sw { nw + m_colcount };
+    const double x { m_cells.x[query] };
+    const double y { m_cells.y[query] };
+
+    const double weight[4] { (1.0 - x) * (1.0 - y), x * (1.0 - y), (1.0 - x) * y, x * y };
+    const std::uint32_t igp[4] { nw, nw + 1, sw, sw + 1 };
+
+    double sum { 0.0 }, weightsum { 0.0 }, validcount { 0.0 };
+    for (std::size_t k = 0; k < 4; ++k)
+    {
+        sum += weight[k] * epoch.value[igp[k]];
+        weightsum += weight[k] * epoch.valid[igp[k]];
+        validcount += epoch.valid[igp[k]];
+    }
+
+    // at least three IGPs, which do not all have weight 0
+    if (!(m_cells.inside[query] > 0.0) || validcount < 3.0 || !(weightsum > 0.0))
+        return false;
+
+    value = sum / weightsum;
+    return true;
+}
+
+} // namespace bnav
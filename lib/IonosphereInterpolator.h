@@ -0,0 +1,75 @@
+#ifndef IONOSPHEREINTERPOLATOR_H
+#define IONOSPHEREINTERPOLATOR_H
+
+#include "BeiDou.h"
+#include "DateTime.h"
+#include "Ionosphere.h"
+#include "TimeSeriesStore.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The IonosphereInterpolator class
+ *
+ * Answers batches of vertical delay queries at pierce points from the grids
+ * of one SV or of a consensus, all of one grid dimension.
+ *
+ * In space the four IGPs around a pierce point are interpolated bilinear. An
+ * IGP without value (9999) is left out and the weights of the others are
+ * normalized, with less than three IGPs there is no value. In time the
+ * values of the grids before and after a query are interpolated linear, if
+ * the grids are at most the maximum gap apart.
+ *
+ * The delays are 0.1 TECU as in IonoGridInfo, 9999 if not available.
+ */
+class IonosphereInterpolator
+{
+    /// grid of one epoch, unavailable IGPs are 0 with weight 0
+    struct Epoch
+    {
+        double time;
+        std::vector<double> value;
+        std::vector<double> valid;
+    };
+
+    IonoGridDimension m_griddim;
+    std::uint32_t m_rowcount;
+    std::uint32_t m_colcount;
+    double m_maxgap;
+    std::vector<Epoch> m_epochs; ///< in time order
+
+    /// cell of each query, reused
+    struct Cells
+    {
+        std::vector<std::uint32_t> index; ///< of the north west IGP
+        std::vector<double> x; ///< offset to the east in cells
+        std::vector<double> y; ///< offset to the south in cells
+        std::vector<double> inside; ///< 1.0, if the cell is in the grid
+    };
+    Cells m_cells;
+
+public:
+    IonosphereInterpolator(const std::uint32_t maxgap = 2 * REGIONAL_GRID_UPDATE_INTERVAL);
+    IonosphereInterpolator(const TimeSeries<Ionosphere> &items, const std::uint32_t maxgap = 2 * REGIONAL_GRID_UPDATE_INTERVAL);
+
+    void addIonosphere(const Ionosphere &iono);
+
+    bool empty() const;
+
+    static double getTime(const DateTime &datetime);
+
+    std::size_t evaluate(const std::vector<double> &latitude, const std::vector<double> &longitude,
+                         const std::vector<double> &time, std::vector<double> &delay);
+
+private:
+    void locateCells(const std::vector<double> &latitude, const std::vector<double> &longitude);
+    bool interpolate(const Epoch &epoch, const std::size_t query, double &value) const;
+};
+
+} // namespace bnav
+
+#endif // IONOSPHEREINTERPOLATOR_H
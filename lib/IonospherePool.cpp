@@ -0,0 +1,42 @@
+#include "IonospherePool.h"
+
+#include <utility>
+
+namespace bnav
+{
+
+IonospherePool::IonospherePool()
+    : m_free()
+{
+}
+
+/**
+ * @brief IonospherePool::acquire Get a model to load into.
+ * @return Recycled model with its grid storage, or an empty one if the pool
+ * is empty. Its content is undefined until load().
+ */
+Ionosphere IonospherePool::acquire()
+{
+    if (m_free.empty())
+        return Ionosphere();
+
+    Ionosphere iono { std::move(m_free.back()) };
+    m_free.pop_back();
+    return iono;
+}
+
+/**
+ * @brief IonospherePool::release Give a model back to the pool.
+ * @param iono The model, its grid storage is kept for the next acquire().
+ */
+void IonospherePool::release(Ionosphere &&iono)
+{
+    m_free.push_back(std::move(iono));
+}
+
+std::size_t IonospherePool::getFreeCount() const
+{
+    return m_free.size();
+}
+
+} // namespace bnav
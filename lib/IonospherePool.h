@@ -0,0 +1,34 @@
+#ifndef IONOSPHEREPOOL_H
+#define IONOSPHEREPOOL_H
+
+#include "Ionosphere.h"
+
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The IonospherePool class
+ *
+ * Keeps Ionosphere models, which are not needed anymore, together with their
+ * grid storage. A model taken from the pool is loaded in place, so in steady
+ * state decoding a grid does not allocate. The pool grows to the peak count
+ * of models alive at the same time.
+ */
+class IonospherePool
+{
+    std::vector<Ionosphere> m_free;
+
+public:
+    IonospherePool();
+
+    Ionosphere acquire();
+    void release(Ionosphere &&iono);
+
+    std::size_t getFreeCount() const;
+};
+
+} // namespace bnav
+
+#endif // IONOSPHEREPOOL_H
@@ -0,0 +1,310 @@
+#include "IonosphereSnapshot.h"
+
+#include "BeiDou.h"
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "Ionosphere.h"
+#include "IonosphereGrid.h"
+#include "SvID.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+const char SNAPSHOT_MAGIC[8] = { 'B', 'N', 'A', 'V', 'I', 'O', 'N', 'O' };
+
+// the layout is the file format, all fields are naturally aligned
+static_assert(sizeof(bnav::IonosphereSnapshot::FileHeader) == 16, "unexpected padding");
+static_assert(sizeof(bnav::IonosphereSnapshot::ModelHeader) == 144, "unexpected padding");
+static_assert(std::is_trivially_copyable<bnav::IonosphereSnapshot::ModelHeader>::value, "not a plain struct");
+
+bnav::IonosphereSnapshot::ModelHeader lcl_getModelHeader(const bnav::SvID &sv, const bnav::Ionosphere &iono)
+{
+    bnav::IonosphereSnapshot::ModelHeader model {};
+    model.prn = sv.getPRN();
+    model.weeknum = iono.getDateOfIssue().getWeekNum();
+    model.sow = iono.getDateOfIssue().getSOW();
+    model.cellcount = static_cast<uint32_t>(iono.getGrid().size());
+
+    const bnav::IonoGridDimension dim { iono.getGridDimension() };
+    model.griddim[0] = dim.latitude_north;
+    model.griddim[1] = dim.latitude_south;
+    model.griddim[2] = dim.latitude_spacing;
+    model.griddim[3] = dim.longitude_west;
+    model.griddim[4] = dim.longitude_east;
+    model.griddim[5] = dim.longitude_spacing;
+
+    const boost::optional<bnav::KlobucharParam> klob { iono.getKlobucharParam() };
+    if (klob)
+    {
+        model.hasklobuchar = 1;
+        model.klobucharbits = klob->rawbits.getBits().to_ullong();
+        const double params[8] = { klob->alpha0, klob->alpha1, klob->alpha2, klob->alpha3,
+                                   klob->beta0, klob->beta1, klob->beta2, klob->beta3 };
+        std::copy(params, params + 8, model.klobuchar);
+    }
+
+    return model;
+}
+
+bnav::IonoGridDimension lcl_getGridDimension(const bnav::IonosphereSnapshot::ModelHeader &model)
+{
+    return bnav::IonoGridDimension(model.griddim[0], model.griddim[1], model.griddim[2],
+                                   model.griddim[3], model.griddim[4], model.griddim[5]);
+}
+
+boost::optional<bnav::KlobucharParam> lcl_getKlobucharParam(const bnav::IonosphereSnapshot::ModelHeader &model)
+{
+    boost::optional<bnav::KlobucharParam> klob;
+    if (model.hasklobuchar == 0)
+        return klob;
+
+    klob = bnav::KlobucharParam();
+    klob->rawbits = bnav::NavBits<64>(std::bitset<64>(model.klobucharbits));
+    klob->alpha0 = model.klobuchar[0];
+    klob->alpha1 = model.klobuchar[1];
+    klob->alpha2 = model.klobuchar[2];
+    klob->alpha3 = model.klobuchar[3];
+    klob->beta0 = model.klobuchar[4];
+    klob->beta1 = model.klobuchar[5];
+    klob->beta2 = model.klobuchar[6];
+    klob->beta3 = model.klobuchar[7];
+    return klob;
+}
+
+bool lcl_isValidSpan(const double first, const double last, const double spacing, const double limit)
+{
+    return std::fabs(first) <= limit && std::fabs(last) <= limit
+            && std::fabs(spacing) > 0.0 && std::fabs(spacing) <= 2.0 * limit;
+}
+
+/**
+ * @brief lcl_isValid Check a model header of a file, before it's used.
+ * @return true, if the model can be restored.
+ */
+bool lcl_isValid(const bnav::IonosphereSnapshot::ModelHeader &model)
+{
+    if (model.prn == 0 || model.prn > bnav::BDS_MAX_PRN || model.sow >= bnav::SECONDS_OF_A_WEEK)
+        return false;
+
+    if (model.cellcount == 0 || model.hasklobuchar > 1)
+        return false;
+
+    // also rejects NaN
+    if (!lcl_isValidSpan(model.griddim[0], model.griddim[1], model.griddim[2], 90.0)
+            || !lcl_isValidSpan(model.griddim[3], model.griddim[4], model.griddim[5], 360.0))
+        return false;
+
+    // rows and columns have to fit into the cells, before they are counted
+    if (std::fabs(model.griddim[0] - model.griddim[1]) / std::fabs(model.griddim[2]) >= model.cellcount
+            || std::fabs(model.griddim[3] - model.griddim[4]) / std::fabs(model.griddim[5]) >= model.cellcount)
+        return false;
+
+    // any grid spacing, e.g. of Klobuchar maps, as long as the cells match it
+    const bnav::IonoGridDimension dim { lcl_getGridDimension(model) };
+    return dim.getItemCountLatitude() * dim.getItemCountLongitude() == model.cellcount;
+}
+
+}
+
+namespace bnav
+{
+
+constexpr uint32_t IonosphereSnapshot::SNAPSHOT_VERSION;
+
+/**
+ * @brief IonosphereSnapshot::write Write all models of a store.
+ *
+ * The snapshot is written aside and renamed, so an existing snapshot is
+ * replaced at once and a reader never sees a partial file. Models, which
+ * read() would reject, e.g. with a grid not matching its dimension, are
+ * refused and no file is written.
+ *
+ * @param filename Snapshot filename, overwritten.
+ * @param store The store.
+ * @return false, if the file could not be written.
+ */
+bool IonosphereSnapshot::write(const std::string &filename, const IonosphereStore &store)
+{
+    const std::string tmpname { filename + ".tmp" };
+    std::ofstream outfile(tmpname, std::ios::binary | std::ios::trunc);
+    if (!outfile.is_open())
+    {
+        std::perror(("Error: Could not open file: " + tmpname).c_str());
+        return false;
+    }
+
+    const std::vector<SvID> svlist { store.getSvList() };
+
+    FileHeader header {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    for (const SvID &sv : svlist)
+        header.modelcount += static_cast<uint32_t>(store.getItemsBySv(sv)->size());
+    outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const char padding[8] = {};
+    for (const SvID &sv : svlist)
+    {
+        for (const Ionosphere &iono : *store.getItemsBySv(sv))
+        {
+            const ModelHeader model { lcl_getModelHeader(sv, iono) };
+            if (!lcl_isValid(model))
+            {
+                std::cerr << "Error: Model of PRN " << sv.getPRN() << " at "
+                          << iono.getDateOfIssue().getDateTimeString()
+                          << " can't be written to snapshot: " << filename << std::endl;
+                outfile.close();
+                std::remove(tmpname.c_str());
+                return false;
+            }
+            outfile.write(reinterpret_cast<const char*>(&model), sizeof(model));
+
+            const IonoGrid &grid = iono.getGrid();
+            const std::streamsize cellbytes { static_cast<std::streamsize>(grid.size() * sizeof(uint16_t)) };
+            outfile.write(reinterpret_cast<const char*>(grid.getVerticalDelayData()), cellbytes);
+            outfile.write(reinterpret_cast<const char*>(grid.getGiveData()), cellbytes);
+            outfile.write(padding, static_cast<std::streamsize>(getCellBytes(model.cellcount)) - 2 * cellbytes);
+        }
+    }
+
+    outfile.close();
+    if (!outfile)
+    {
+        std::perror(("Error while writing file: " + tmpname).c_str());
+        std::remove(tmpname.c_str());
+        return false;
+    }
+
+    if (std::rename(tmpname.c_str(), filename.c_str()) != 0)
+    {
+        std::perror(("Error: Could not rename file: " + tmpname).c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief IonosphereSnapshot::read Add all models of a snapshot to a store.
+ *
+ * The file is mapped into memory and checked completely, before any model is
+ * added. Models of the same SV and date of issue are replaced.
+ *
+ * @param filename Snapshot filename.
+ * @param store The store.
+ * @return false, if the file could not be read or is malformed, the store is
+ * unchanged then.
+ */
+bool IonosphereSnapshot::read(const std::string &filename, IonosphereStore &store)
+{
+    const int fd { ::open(filename.c_str(), O_RDONLY) };
+    if (fd < 0)
+    {
+        std::perror(("Error: Could not open file: " + filename).c_str());
+        return false;
+    }
+
+    struct stat filestat;
+    if (::fstat(fd, &filestat) != 0 || filestat.st_size < static_cast<off_t>(sizeof(FileHeader)))
+    {
+        std::cerr << "Error: Malformed snapshot: " << filename << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    const std::size_t size { static_cast<std::size_t>(filestat.st_size) };
+    void *data { ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) };
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        std::perror(("Error: Could not map file: " + filename).c_str());
+        return false;
+    }
+
+    const char *bytes { static_cast<const char*>(data) };
+    const bool isValid { parse(bytes, size, nullptr) };
+    if (isValid)
+        parse(bytes, size, &store);
+    else
+        std::cerr << "Error: Malformed snapshot: " << filename << std::endl;
+
+    ::munmap(data, size);
+    return isValid;
+}
+
+/**
+ * @brief IonosphereSnapshot::getCellBytes Size of the cells of one model.
+ * @param cellcount Cell count.
+ * @return Bytes of vertical delay and GIVE, padded to a multiple of 8.
+ */
+std::size_t IonosphereSnapshot::getCellBytes(const uint32_t cellcount)
+{
+    return (2 * cellcount * sizeof(uint16_t) + 7) / 8 * 8;
+}
+
+/**
+ * @brief IonosphereSnapshot::parse Run through the models of a snapshot.
+ * @param data Content of the file, 8 byte aligned.
+ * @param size Size of the file.
+ * @param store Store, which takes the models. nullptr to check the file only.
+ * @return false, if the file is malformed.
+ */
+bool IonosphereSnapshot::parse(const char *data, const std::size_t size, IonosphereStore *store)
+{
+    assert(size >= sizeof(FileHeader));
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION)
+        return false;
+
+    std::size_t offset { sizeof(header) };
+    IonoGrid grid; // reused for all models
+    for (uint32_t i = 0; i < header.modelcount; ++i)
+    {
+        ModelHeader model;
+        if (size - offset < sizeof(model))
+            return false;
+        std::memcpy(&model, data + offset, sizeof(model));
+        offset += sizeof(model);
+
+        const std::size_t cellbytes { getCellBytes(model.cellcount) };
+        if (!lcl_isValid(model) || size - offset < cellbytes)
+            return false;
+
+        if (store)
+        {
+            const uint16_t *cells { reinterpret_cast<const uint16_t*>(data + offset) };
+            grid.assign(cells, cells + model.cellcount, model.cellcount);
+
+            Ionosphere iono;
+            iono.setGridDimension(lcl_getGridDimension(model));
+            iono.setGrid(grid);
+            iono.setDateOfIssue(DateTime(TimeSystem::BDT, model.weeknum, model.sow));
+            iono.setKlobucharParam(lcl_getKlobucharParam(model));
+            store->addIonosphere(SvID(model.prn), std::move(iono));
+        }
+        offset += cellbytes;
+    }
+
+    return offset == size;
+}
+
+} // namespace bnav
@@ -0,0 +1,59 @@
+#ifndef IONOSPHERESNAPSHOT_H
+#define IONOSPHERESNAPSHOT_H
+
+#include "IonosphereStore.h"
+
+#include <cstdint>
+#include <string>
+
+namespace bnav
+{
+
+/**
+ * @brief The IonosphereSnapshot class
+ *
+ * Binary snapshot of an IonosphereStore, which is restored without decoding
+ * any navigation data again.
+ *
+ * The file is a FileHeader followed by the models of all SVs, sorted by PRN
+ * and date of issue. Each model is a ModelHeader followed by the vertical
+ * delays and then the GIVE of all cells as in IonoGrid, 16 bit each, padded
+ * to a multiple of 8 bytes. All values are in host byte order.
+ */
+class IonosphereSnapshot
+{
+public:
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+    struct FileHeader
+    {
+        char magic[8]; ///< "BNAVIONO"
+        uint32_t version;
+        uint32_t modelcount;
+    };
+
+    struct ModelHeader
+    {
+        uint32_t prn;
+        uint32_t weeknum; ///< date of issue, BDT
+        uint32_t sow;
+        uint32_t cellcount;
+        double griddim[6]; ///< as in IonoGridDimension
+        uint32_t hasklobuchar;
+        uint32_t reserved;
+        uint64_t klobucharbits; ///< KlobucharParam::rawbits
+        double klobuchar[8]; ///< alpha0 to alpha3, beta0 to beta3
+    };
+
+    static bool write(const std::string &filename, const IonosphereStore &store);
+    static bool read(const std::string &filename, IonosphereStore &store);
+
+    static std::size_t getCellBytes(const uint32_t cellcount);
+
+private:
+    static bool parse(const char *data, const std::size_t size, IonosphereStore *store);
+};
+
+} // namespace bnav
+
+#endif // IONOSPHERESNAPSHOT_H
@@ -1,5 +1,9 @@
 #include "IonosphereStore.h"
 
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
 namespace bnav
 {
 
@@ -10,7 +14,55 @@ namespace bnav
  */
 IonosphereStore::IonosphereStore()
     : m_store()
+    , m_maxcount(0)
+    , m_maxage(0)
+    , m_queueEvicted(false)
+    , m_evicted()
+    , m_evictedCount(0)
+{
+}
+
+/**
+ * @brief IonosphereStore::setRetention Limit the models kept per SV, applied
+ * on the next insertion of each SV.
+ * @param maxcount Maximum count of models per SV, 0 for no limit.
+ * @param maxage Maximum age of a model before the latest one of the SV [s],
+ * 0 for no limit.
+ */
+void IonosphereStore::setRetention(const std::size_t maxcount, const std::uint32_t maxage)
+{
+    m_maxcount = maxcount;
+    m_maxage = maxage;
+}
+
+/**
+ * @brief IonosphereStore::setQueueEvicted Keep evicted models until they are
+ * taken by takeEvicted(), otherwise they are dropped.
+ * @param queue true, to queue evicted models.
+ */
+void IonosphereStore::setQueueEvicted(const bool queue)
 {
+    m_queueEvicted = queue;
+}
+
+/**
+ * @brief IonosphereStore::takeEvicted Take all queued models, oldest of each
+ * SV first.
+ *
+ * The queue is swapped with models, which is cleared before. Pass the same
+ * vector again, after its models are written, so its storage is reused.
+ *
+ * @param models Takes the evicted models.
+ */
+void IonosphereStore::takeEvicted(EvictedModels &models)
+{
+    models.clear();
+    m_evicted.swap(models);
+}
+
+std::size_t IonosphereStore::getEvictedCount() const
+{
+    return m_evictedCount;
 }
 
 /**
@@ -21,9 +73,61 @@ IonosphereStore::IonosphereStore()
  * @param sv The SvID.
  * @param iono The Ionosphere object.
  */
-void IonosphereStore::addIonosphere(const SvID &sv, const Ionosphere &iono)
+void IonosphereStore::addIonosphere(const SvID &sv, Ionosphere iono)
 {
-    m_store[sv][iono.getDateOfIssue()] = iono;
+    const DateTime dt { iono.getDateOfIssue() };
+    m_store.insert(sv, dt, std::move(iono));
+
+    if (m_maxcount > 0 || m_maxage > 0)
+        evict(sv);
+}
+
+/**
+ * @brief IonosphereStore::evict Remove the models of a SV beyond the
+ * retention and queue them.
+ *
+ * Usually one model is evicted for each one inserted, so the storage of a SV
+ * stays at the same size.
+ *
+ * @param sv The SvID.
+ */
+void IonosphereStore::evict(const SvID &sv)
+{
+    TimeSeries<Ionosphere> &items = m_store.get(sv);
+
+    std::size_t count = 0;
+    if (m_maxcount > 0 && items.size() > m_maxcount)
+        count = items.size() - m_maxcount;
+
+    const std::uint64_t latest { items.getEpoch(items.size() - 1) };
+    if (m_maxage > 0 && latest > m_maxage)
+        count = std::max(count, items.countBefore(latest - m_maxage));
+
+    if (count == 0)
+        return;
+
+    m_evictedCount += count;
+    items.evict(count, [this, &sv](Ionosphere &iono)
+    {
+        if (m_queueEvicted)
+            m_evicted.emplace_back(sv, std::move(iono));
+    });
+}
+
+/**
+ * @brief IonosphereStore::recycle Move all models of a SV into a pool.
+ * @param sv The SvID.
+ * @param pool Pool, which takes the models.
+ */
+void IonosphereStore::recycle(const SvID &sv, IonospherePool &pool)
+{
+    if (!m_store.contains(sv))
+        return;
+
+    TimeSeries<Ionosphere> &items = m_store.get(sv);
+    for (Ionosphere &item : items)
+        pool.release(std::move(item));
+    items.clear();
 }
 
 /**
@@ -32,55 +136,49 @@ void IonosphereStore::addIonosphere(const SvID &sv, const Ionosphere &iono)
  */
 std::vector< SvID > IonosphereStore::getSvList() const
 {
-    std::vector< SvID > svlist {};
-
-    for (const auto & elem : m_store)
-        svlist.push_back(elem.first);
-
-    return svlist;
+    return m_store.getSvList();
 }
 
-boost::optional< std::map<DateTime, Ionosphere> > IonosphereStore::getItemsBySv(const SvID &sv) const
+/**
+ * @brief IonosphereStore::getItemsBySv Get all models of a SV.
+ * @param sv The SvID.
+ * @return Reference to the models of the SV, valid until the store is
+ * modified.
+ */
+boost::optional< const TimeSeries<Ionosphere>& > IonosphereStore::getItemsBySv(const SvID &sv) const
 {
-    boost::optional< std::map<DateTime, Ionosphere> > items;
+    boost::optional< const TimeSeries<Ionosphere>& > items;
 
-    const auto it = m_store.find(sv);
-    if (it != m_store.end())
-        items = it->second;
+    if (m_store.contains(sv))
+        items = m_store.get(sv);
 
     return items;
 }
 
 bool IonosphereStore::hasDataForSv(const SvID &sv) const
 {
-    const auto it = m_store.find(sv);
-    // sv doesn't exist in store
-    if (it == m_store.end())
-        return false;
-
-    return !it->second.empty();
+    return m_store.hasDataForSv(sv);
 }
 
 /**
  * @brief IonosphereStore::getIonosphere Get an Ionosphere object.
  * @param sv The SvID.
  * @param datetime Date of specific Ionosphere.
- * @return Pointer to Ionosphere for SV.
+ * @return Reference to Ionosphere for SV, valid until the store is modified.
  */
-boost::optional<Ionosphere> IonosphereStore::getIonosphere(const SvID &sv, const DateTime &datetime) const
+boost::optional<const Ionosphere&> IonosphereStore::getIonosphere(const SvID &sv, const DateTime &datetime) const
 {
-    boost::optional<Ionosphere> ion;
-    std::map<DateTime, Ionosphere> dateion;
+    boost::optional<const Ionosphere&> ion;
 
     // find sv
-    const auto dateit = m_store.find(sv);
-    if (dateit != m_store.end())
-        dateion = dateit->second;
+    if (!m_store.contains(sv))
+        return ion;
 
     // find date
-    const auto it = dateion.find(datetime);
-    if (it != dateion.end())
-        ion = it->second;
+    const TimeSeries<Ionosphere> &dateion = m_store.get(sv);
+    const std::size_t index { dateion.find(datetime) };
+    if (index < dateion.size())
+        ion = dateion[index];
 
     return ion;
 }
@@ -95,10 +193,10 @@ void IonosphereStore::dumpStoreStatistics(const std::string &name) const
         return;
     }
 
-    for (const auto & item : m_store)
+    for (const SvID &sv : m_store.getSvList())
     {
-        std::cout << item.first.getPRN() << ": "
-                  << item.second.size() << std::endl;
+        std::cout << sv.getPRN() << ": "
+                  << m_store.get(sv).size() << std::endl;
     }
 }
 
@@ -113,51 +211,55 @@ void IonosphereStore::dumpGridAvailability(const SvID &sv) const
     std::cout << "Grid availability" << std::endl;
 
     // find sv
-    const auto svit = m_store.find(sv);
     // sv is not in store
-    if (svit == m_store.end())
+    if (!m_store.contains(sv))
         return;
 
-    const auto svitems = svit->second;
+    const TimeSeries<Ionosphere> &svitems = m_store.get(sv);
 
     if (svitems.empty())
     {
         std::cout << "No data for SV: " << sv.getPRN() << std::endl;
         return;
     }
-    else
-    {
-        std::cout << "Total map count: " << svitems.size() << std::endl;
-    }
+
+    dumpGridAvailability(svitems);
+}
+
+/**
+ * @brief IonosphereStore::dumpGridAvailability Generate a simple grid
+ * availability map of any models.
+ *
+ * @param items Models with the same grid dimension, not empty.
+ */
+void IonosphereStore::dumpGridAvailability(const TimeSeries<Ionosphere> &items)
+{
+    assert(!items.empty());
+    std::cout << "Total map count: " << items.size() << std::endl;
 
     // set same grid dimension
-    const IonoGridDimension dim = svitems.begin()->second.getGridDimension();
+    const IonoGridDimension dim = items.front().getGridDimension();
     const DateTime dtref(TimeSystem::BDT, 0, 0); // just an arbitrary date
     Ionosphere ionoref;
     ionoref.setGridDimension(dim);
     ionoref.setDateOfIssue(dtref);
     // get grid and reuse tecu as counter ;)
-    std::vector<IonoGridInfo> igpref = ionoref.getGrid();
+    IonoGrid igpref = ionoref.getGrid();
 
     // zero initialize every single IGP
-    for (auto it = igpref.begin(); it != igpref.end(); ++it)
-        it->setVerticalDelay_TECU(0);
+    for (std::size_t i = 0; i < igpref.size(); ++i)
+        igpref.setVerticalDelay_TECU(i, 0);
 
     // loop through each ionospheric model for SV in store
-    for (const auto & elem : svitems)
+    for (const Ionosphere &elem : items)
     {
-        const std::vector<IonoGridInfo> igp = elem.second.getGrid();
-        std::size_t i = 0;
+        const IonoGrid &igp = elem.getGrid();
 
-        for (auto igpelem : igp)
+        for (std::size_t i = 0; i < igp.size(); ++i)
         {
             // increment if real IGP point has data
-            if (igpelem.getVerticalDelay_TECU() != 9999)
-            {
-                igpref[i].setVerticalDelay_TECU(igpref[i].getVerticalDelay_TECU() + 1);
-            }
-
-            ++i;
+            if (igp.getVerticalDelay_TECU(i) != 9999)
+                igpref.setVerticalDelay_TECU(i, igpref.getVerticalDelay_TECU(i) + 1);
         }
     }
 
@@ -2,35 +2,65 @@
 #define IONOSPHERESTORE_H
 
 #include "Ionosphere.h"
+#include "IonospherePool.h"
 #include "DateTime.h"
 #include "SvID.h"
+#include "TimeSeriesStore.h"
 
-#include <map>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 #include <boost/optional.hpp>
 
 namespace bnav
 {
 
-//TODO: class template -> eph,alm,..Store are all nearly identical
+/**
+ * @brief The IonosphereStore class
+ *
+ * Models of each SV by date of issue. By default all models are kept, with a
+ * retention only the latest ones of each SV. Older models are evicted on
+ * insertion and may be queued. The caller takes the queue and hands it on,
+ * e.g. to an Ionex or archive writer in another thread, so writing never
+ * blocks the insertion.
+ */
 class IonosphereStore
 {
-    std::map<SvID, std::map< DateTime, Ionosphere > > m_store;
+public:
+    typedef std::vector< std::pair<SvID, Ionosphere> > EvictedModels;
+
+private:
+    TimeSeriesStore<Ionosphere> m_store;
+    std::size_t m_maxcount; ///< models per SV, 0 for no limit
+    std::uint32_t m_maxage; ///< seconds before the latest model, 0 for no limit
+    bool m_queueEvicted;
+    EvictedModels m_evicted; ///< evicted models, until taken
+    std::size_t m_evictedCount;
 
 public:
     IonosphereStore();
 
-    void addIonosphere(const SvID &sv, const Ionosphere &iono);
+    void setRetention(const std::size_t maxcount, const std::uint32_t maxage);
+    void setQueueEvicted(const bool queue);
+    void takeEvicted(EvictedModels &models);
+    std::size_t getEvictedCount() const;
+
+    void addIonosphere(const SvID &sv, Ionosphere iono);
+    void recycle(const SvID &sv, IonospherePool &pool);
 
     bool hasDataForSv(const SvID &sv) const;
 
     std::vector< SvID > getSvList() const;
-    boost::optional< std::map<DateTime, Ionosphere> > getItemsBySv(const SvID &sv) const;
-    boost::optional< Ionosphere > getIonosphere(const SvID &sv, const DateTime &datetime) const;
+    boost::optional< const TimeSeries<Ionosphere>& > getItemsBySv(const SvID &sv) const;
+    boost::optional< const Ionosphere& > getIonosphere(const SvID &sv, const DateTime &datetime) const;
 
     void dumpStoreStatistics(const std::string &name) const;
     void dumpGridAvailability(const SvID &sv) const;
+    static void dumpGridAvailability(const TimeSeries<Ionosphere> &items);
+
+private:
+    void evict(const SvID &sv);
 };
 
 } // namespace bnav
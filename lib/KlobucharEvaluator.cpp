@@ -0,0 +1,185 @@
+#include "KlobucharEvaluator.h"
+
+#include "BeiDou.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+
+/// ionospheric delay reaches its maximum at 14h local time
+constexpr int32_t MAXIMUM_LOCALTIME = 50400;
+
+/// delay without cosine term
+constexpr double NIGHT_DELAY = 5.0e-9;
+
+int32_t lcl_calcLocalTime(const uint32_t time, const double lambda)
+{
+    // convert to semicircle
+    const double semilambda { lambda / 180.0 };
+
+    int32_t localtime { static_cast<int32_t>(std::lround(4.32e4 * semilambda)) + static_cast<int32_t>(time) };
+
+    if (localtime > 86400)
+        localtime = localtime - 86400;
+    if (localtime < 0)
+        localtime = localtime + 86400;
+
+    return localtime;
+}
+
+/**
+ * @brief lcl_calcAmplitudePeriod Calculate amplitude and period of the
+ * cosine at a latitude.
+ * @param klob Klobuchar parameters.
+ * @param phi Latitude in degrees.
+ * @param amplitude Amplitude in seconds.
+ * @param period Period in seconds.
+ */
+void lcl_calcAmplitudePeriod(const bnav::KlobucharParam &klob, const double phi, double &amplitude, double &period)
+{
+    // convert to semicircle
+    const double semiphi { phi / 180.0 };
+
+    // chinese don't do geomagnetic latitude
+    const double absphim { std::fabs(semiphi) };
+
+    amplitude = klob.alpha0 + absphim * (klob.alpha1 + absphim * (klob.alpha2 + absphim * klob.alpha3));
+    period = klob.beta0 + absphim * (klob.beta1 + absphim * (klob.beta2 + absphim * klob.beta3));
+
+    // amplitude is negative on the southern sphere
+    // changing the sign isn't much better.
+    if (amplitude < 0.0)
+        amplitude = 0.0;
+    if (period < 72000.0)
+        period = 72000.0;
+    // this causes the vertical line:
+    if (period > 172800.0)
+        period = 172800.0;
+}
+
+// exact comparison, equal doubles give equal rows
+bool lcl_isEqual(const double lhs, const double rhs)
+{
+    return !(lhs < rhs) && !(rhs < lhs);
+}
+
+bool lcl_isDayTime(const int32_t localtime, const double period)
+{
+    return std::abs(localtime - MAXIMUM_LOCALTIME) < (period / 4.0);
+}
+
+// offset 50400 is 14h at local time, this is when ionospheric delay
+// reaches maximum usually
+double lcl_calcCosine(const int32_t localtime, const double period)
+{
+    const double x { 2 * bnav::PI * (localtime - MAXIMUM_LOCALTIME) / period };
+    return std::cos(x);
+}
+
+}
+
+namespace bnav
+{
+
+KlobucharEvaluator::KlobucharEvaluator(const KlobucharParam &klob)
+    : m_klob(klob)
+    , m_localtime()
+    , m_rows()
+{
+}
+
+/**
+ * @brief KlobucharEvaluator::getVerticalDelay Calculate Klobuchar correction
+ * at position (phi, lambda). This is only vertical delay, no slant!
+ *
+ * @param time Second of day.
+ * @param phi Phi in degrees, south of equator is negative.
+ * @param lambda Lambda in degrees, west of Greenwich is negative.
+ * @return Vertical delay in meters.
+ *
+ * References:
+ * [1] ICD, 5.2.4.7 Ionospheric Delay Model Parameters, pp. 25
+ * [2] Ionospheric Time-Delay Algorithm for Single Frequency GPS Users,
+ *     John. A. Klobuchar, 1987
+ * [3] http://www.navipedia.net/index.php/Klobuchar_Ionospheric_Model
+ */
+double KlobucharEvaluator::getVerticalDelay(const uint32_t time, const double phi, const double lambda) const
+{
+    assert(time < 86400);
+
+    const int32_t localtime { lcl_calcLocalTime(time, lambda) };
+
+    double amplitude, period;
+    lcl_calcAmplitudePeriod(m_klob, phi, amplitude, period);
+
+    // ignore slant factor F, because we want vertical delay
+    const double tiono { lcl_isDayTime(localtime, period) ? NIGHT_DELAY + amplitude * lcl_calcCosine(localtime, period) : NIGHT_DELAY };
+
+    return tiono * SPEED_OF_LIGHT;
+}
+
+/**
+ * @brief KlobucharEvaluator::evaluate Fill a grid with the vertical delay of
+ * each cell.
+ * @param dim Grid dimension, row by row from north to south.
+ * @param time Second of day.
+ * @param grid The grid, its storage is reused.
+ */
+void KlobucharEvaluator::evaluate(const IonoGridDimension &dim, const uint32_t time, IonoGrid &grid)
+{
+    assert(time < 86400);
+
+    const std::size_t rowcount = dim.getItemCountLatitude();
+    const std::size_t colcount = dim.getItemCountLongitude();
+
+    m_localtime.resize(colcount);
+    for (std::size_t col = 0; col < colcount; ++col)
+        m_localtime[col] = lcl_calcLocalTime(time, dim.longitude_west + static_cast<double>(col) * dim.longitude_spacing);
+
+    IonoGridInfo night;
+    night.loadFromMeter(NIGHT_DELAY * SPEED_OF_LIGHT);
+
+    grid.clear();
+    grid.reserve(rowcount * colcount);
+    m_rows.clear();
+
+    for (std::size_t row = 0; row < rowcount; ++row)
+    {
+        double amplitude, period;
+        lcl_calcAmplitudePeriod(m_klob, dim.latitude_north + static_cast<double>(row) * dim.latitude_spacing, amplitude, period);
+
+        const auto same = std::find_if(m_rows.begin(), m_rows.end(), [&](const RowParam &param)
+        {
+            return lcl_isEqual(param.amplitude, amplitude) && lcl_isEqual(param.period, period);
+        });
+        if (same != m_rows.end())
+        {
+            for (std::size_t col = 0; col < colcount; ++col)
+                grid.push_back(grid[same->first + col]);
+            continue;
+        }
+
+        m_rows.push_back(RowParam { amplitude, period, grid.size() });
+
+        for (std::size_t col = 0; col < colcount; ++col)
+        {
+            const int32_t localtime { m_localtime[col] };
+            if (lcl_isDayTime(localtime, period))
+            {
+                IonoGridInfo info;
+                info.loadFromMeter((NIGHT_DELAY + amplitude * lcl_calcCosine(localtime, period)) * SPEED_OF_LIGHT);
+                grid.push_back(info);
+            }
+            else
+            {
+                grid.push_back(night);
+            }
+        }
+    }
+}
+
+} // namespace bnav
@@ -0,0 +1,49 @@
+#ifndef KLOBUCHAREVALUATOR_H
+#define KLOBUCHAREVALUATOR_H
+
+#include "Ephemeris.h"
+#include "Ionosphere.h"
+#include "IonosphereGrid.h"
+#include "IonosphereGridInfo.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The KlobucharEvaluator class
+ *
+ * Evaluates the BDS Klobuchar model on a grid. Amplitude and period depend
+ * only on the latitude, the local time only on the longitude, so they are
+ * computed once per row and column. Rows of equal amplitude and period, e.g.
+ * of both hemispheres, are copied. The cosine is needed only at day time,
+ * all other cells get the constant night time delay.
+ *
+ * The grid is bit-identical to getVerticalDelay() at each cell.
+ */
+class KlobucharEvaluator
+{
+    KlobucharParam m_klob;
+    /// evaluated row
+    struct RowParam
+    {
+        double amplitude;
+        double period;
+        std::size_t first; ///< index of its first cell
+    };
+
+    std::vector<int32_t> m_localtime; ///< of each column, reused
+    std::vector<RowParam> m_rows; ///< of the distinct rows, reused
+
+public:
+    KlobucharEvaluator(const KlobucharParam &klob);
+
+    double getVerticalDelay(const uint32_t time, const double phi, const double lambda) const;
+    void evaluate(const IonoGridDimension &dim, const uint32_t time, IonoGrid &grid);
+};
+
+} // namespace bnav
+
+#endif // KLOBUCHAREVALUATOR_H
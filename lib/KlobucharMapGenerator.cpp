@@ -0,0 +1,117 @@
+#include "KlobucharMapGenerator.h"
+
+#include "BeiDou.h"
+#include "KlobucharEvaluator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+namespace
+{
+
+bnav::DateTime lcl_addSeconds(const bnav::DateTime &dt, const uint32_t seconds)
+{
+    const uint32_t sow { dt.getSOW() + seconds };
+    return bnav::DateTime(bnav::TimeSystem::BDT, dt.getWeekNum() + sow / bnav::SECONDS_OF_A_WEEK, sow % bnav::SECONDS_OF_A_WEEK);
+}
+
+void lcl_evaluate(const bnav::KlobucharMapGenerator::Epoch &epoch, const bnav::IonoGridDimension &griddim, bnav::IonoGrid &grid)
+{
+    bnav::KlobucharEvaluator(epoch.param).evaluate(griddim, epoch.datetime.getSOW() % bnav::SECONDS_OF_A_DAY, grid);
+}
+
+}
+
+namespace bnav
+{
+
+/**
+ * @brief KlobucharMapGenerator::KlobucharMapGenerator
+ * @param griddim Grid of the maps.
+ * @param interval Interval of the maps in seconds.
+ * @param validity Maximum validity of a model in seconds.
+ * @param threadcount Count of maps evaluated at once.
+ */
+KlobucharMapGenerator::KlobucharMapGenerator(const IonoGridDimension &griddim, const uint32_t interval,
+                                             const uint32_t validity, const std::size_t threadcount)
+    : m_griddim(griddim)
+    , m_interval(interval)
+    , m_validity(validity)
+    , m_threadcount(threadcount)
+{
+    assert(m_interval > 0);
+    assert(m_threadcount > 0);
+}
+
+/**
+ * @brief KlobucharMapGenerator::getEpochs Get the epochs of all maps.
+ * @param models Klobuchar models by date of issue.
+ * @param until No maps after this time.
+ * @return Epochs in time order.
+ */
+std::vector<KlobucharMapGenerator::Epoch> KlobucharMapGenerator::getEpochs(const TimeSeries<Ionosphere> &models, const boost::posix_time::ptime &until) const
+{
+    std::vector<Epoch> epochs;
+    for (std::size_t i = 0; i < models.size(); ++i)
+    {
+        const boost::optional<KlobucharParam> param { models[i].getKlobucharParam() };
+        assert(param);
+
+        const std::size_t next { i + 1 };
+        for (uint32_t offset = 0; offset < std::max(m_validity, m_interval); offset += m_interval)
+        {
+            const DateTime epoch { lcl_addSeconds(models.getDateTime(i), offset) };
+            if ((next < models.size() && !(epoch < models.getDateTime(next))) || epoch.get_ptime() > until)
+                break;
+
+            epochs.push_back(Epoch { epoch, *param });
+        }
+    }
+
+    return epochs;
+}
+
+/**
+ * @brief KlobucharMapGenerator::write Write the maps of all models into an
+ * Ionex file.
+ * @param models Klobuchar models by date of issue.
+ * @param until No maps after this time.
+ * @param writer Opened writer, finalized afterwards.
+ * @return false, if there are no maps.
+ */
+bool KlobucharMapGenerator::write(const TimeSeries<Ionosphere> &models, const boost::posix_time::ptime &until, IonexWriter &writer) const
+{
+    const std::vector<Epoch> epochs { getEpochs(models, until) };
+    if (epochs.empty())
+        return false;
+
+    writer.writeHeader(epochs.front().datetime, epochs.back().datetime, m_griddim);
+
+    // one grid per thread, reused for all blocks
+    std::vector<IonoGrid> grids(std::min(m_threadcount, epochs.size()));
+    for (std::size_t first = 0; first < epochs.size(); first += grids.size())
+    {
+        const std::size_t count { std::min(grids.size(), epochs.size() - first) };
+        if (count == 1)
+        {
+            lcl_evaluate(epochs[first], m_griddim, grids[0]);
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            for (std::size_t i = 0; i < count; ++i)
+                workers.emplace_back(lcl_evaluate, std::cref(epochs[first + i]), std::cref(m_griddim), std::ref(grids[i]));
+            for (std::thread &worker : workers)
+                worker.join();
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            writer.writeMap(epochs[first + i].datetime, grids[i]);
+    }
+
+    writer.finalize();
+    return true;
+}
+
+} // namespace bnav
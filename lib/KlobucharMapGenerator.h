@@ -0,0 +1,55 @@
+#ifndef KLOBUCHARMAPGENERATOR_H
+#define KLOBUCHARMAPGENERATOR_H
+
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "IonexWriter.h"
+#include "Ionosphere.h"
+#include "TimeSeriesStore.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace bnav
+{
+
+/**
+ * @brief The KlobucharMapGenerator class
+ *
+ * Evaluates Klobuchar models at any grid spacing and interval. A model is
+ * valid from its date of issue until the next model, at most for one update
+ * interval. Within that time it is evaluated at every epoch of the interval,
+ * because the map follows the local time.
+ *
+ * The maps are evaluated in parallel, some epochs at once, and streamed into
+ * an IonexWriter, so at most one map per thread is in memory.
+ */
+class KlobucharMapGenerator
+{
+public:
+    /// epoch of a map and its model
+    struct Epoch
+    {
+        DateTime datetime;
+        KlobucharParam param;
+    };
+
+private:
+    IonoGridDimension m_griddim;
+    uint32_t m_interval;
+    uint32_t m_validity;
+    std::size_t m_threadcount;
+
+public:
+    KlobucharMapGenerator(const IonoGridDimension &griddim, const uint32_t interval,
+                          const uint32_t validity, const std::size_t threadcount = 1);
+
+    std::vector<Epoch> getEpochs(const TimeSeries<Ionosphere> &models, const boost::posix_time::ptime &until) const;
+    bool write(const TimeSeries<Ionosphere> &models, const boost::posix_time::ptime &until, IonexWriter &writer) const;
+};
+
+} // namespace bnav
+
+#endif // KLOBUCHARMAPGENERATOR_H
@@ -9,8 +9,7 @@ namespace bnav
  * Counts all messages of one SV.
  */
 MessageStatistic::MessageStatistic()
-    : m_count()
-    , m_firstlast()
+    : m_stat()
 {
 }
 
@@ -18,24 +17,50 @@ void MessageStatistic::add(const SvID &sv, const DateTime &dt)
 {
     // FIXME: at the moment we ignore data gaps
 
+    // if it's the first element, initialize
+    if (!m_stat.contains(sv))
+    {
+        MessageCount &item = m_stat.insert(sv);
+        item.count = 1;
+        item.first = dt;
+        item.last = dt;
+        return;
+    }
+
     // increment message counter for SV
-    ++m_count[sv];
+    MessageCount &item = m_stat.get(sv);
+    ++item.count;
 
     // keep info about first and last message date
-    const auto item = m_firstlast.find(sv);
-    if (item != m_firstlast.end())
-    {
-        // first
-        if (m_firstlast[sv].first > dt)
-            m_firstlast[sv].first = dt;
-        // last
-        if (m_firstlast[sv].second < dt)
-            m_firstlast[sv].second = dt;
-    }
-    else
+    if (item.first > dt)
+        item.first = dt;
+    if (item.last < dt)
+        item.last = dt;
+}
+
+/**
+ * @brief MessageStatistic::merge Add the counts of another statistic.
+ * @param other Statistic, e.g. of another thread.
+ */
+void MessageStatistic::merge(const MessageStatistic &other)
+{
+    for (const SvID &sv : other.m_stat.getSvList())
     {
-        // if it's the first element, initialize
-        m_firstlast[sv] = std::make_pair(dt, dt);
+        const MessageCount &rhs = other.m_stat.get(sv);
+
+        if (!m_stat.contains(sv))
+        {
+            m_stat.insert(sv) = rhs;
+            continue;
+        }
+
+        MessageCount &item = m_stat.get(sv);
+        item.count += rhs.count;
+
+        if (item.first > rhs.first)
+            item.first = rhs.first;
+        if (item.last < rhs.last)
+            item.last = rhs.last;
     }
 }
 
@@ -43,17 +68,16 @@ void MessageStatistic::dump() const
 {
     std::cout << "Message statistic:" << std::endl;
 
-    for (const auto elem : m_count)
+    for (const SvID &sv : m_stat.getSvList())
     {
-        const auto it = m_firstlast.find(elem.first);
-        assert(it != m_firstlast.end());
+        const MessageCount &item = m_stat.get(sv);
 
-        std::cout << std::setw(2) << elem.first.getPRN() << ": "
-                  << std::setw(6) << elem.second
+        std::cout << std::setw(2) << sv.getPRN() << ": "
+                  << std::setw(6) << item.count
                   << " first: "
-                  << it->second.first.getDateTimeString()
+                  << item.first.getDateTimeString()
                   << " last: "
-                  << it->second.second.getDateTimeString();
+                  << item.last.getDateTimeString();
 
         std::cout << std::endl;
     }
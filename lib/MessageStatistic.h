@@ -1,23 +1,31 @@
 #ifndef MESSAGESTATISTIC_H
 #define MESSAGESTATISTIC_H
 
+#include "SvArray.h"
 #include "SvID.h"
 #include "DateTime.h"
 
-#include <map>
+#include <cstdint>
 
 namespace bnav
 {
 
 class MessageStatistic
 {
-    std::map< SvID, uint32_t > m_count;
-    std::map< SvID, std::pair<DateTime, DateTime> > m_firstlast;
+    struct MessageCount
+    {
+        uint32_t count;
+        DateTime first;
+        DateTime last;
+    };
+
+    SvArray<MessageCount> m_stat;
 
 public:
     MessageStatistic();
 
     void add(const SvID &sv, const DateTime &dt);
+    void merge(const MessageStatistic &other);
 
     void dump() const;
 };
@@ -0,0 +1,70 @@
+#include "PageFilter.h"
+
+#include "BeiDou.h"
+
+namespace bnav
+{
+
+/**
+ * @brief PageFilter::PageFilter
+ *
+ * No product is enabled by default, which means no page is required.
+ */
+PageFilter::PageFilter()
+    : m_klobuchar(false)
+    , m_regionalgrid(false)
+{
+}
+
+void PageFilter::enableProduct(const Product product)
+{
+    if (product == Product::KLOBUCHAR)
+        m_klobuchar = true;
+    else
+        m_regionalgrid = true;
+}
+
+bool PageFilter::isProductEnabled(const Product product) const
+{
+    return (product == Product::KLOBUCHAR) ? m_klobuchar : m_regionalgrid;
+}
+
+/**
+ * @brief PageFilter::isRequired Check if a page is used by any enabled product.
+ *
+ * The Klobuchar parameters come with WN and SOW of the ephemeris data (D1
+ * subframe 1 or D2 frame 1 pages 1 and 2). The regional grid is only
+ * broadcast by GEO satellites and needs both IGP blocks of D2 frame 5 and
+ * the time of D2 frame 1, so D1 pages are only required for Klobuchar.
+ *
+ * @param sv SvID of the Subframe.
+ * @param sf Subframe with at least a decoded header.
+ * @return true, if the page has to be decoded and buffered.
+ */
+bool PageFilter::isRequired(const SvID &sv, const Subframe &sf) const
+{
+    if (!m_klobuchar && !m_regionalgrid)
+        return false;
+
+    const uint32_t fraid { sf.getFrameID() };
+    const std::size_t pnum { sf.getPageNum() };
+
+    if (!sv.isGeo())
+        return m_klobuchar && fraid == 1;
+
+    if (fraid == 1)
+        return pnum >= 1 && pnum <= D2_KLOBUCHAR_PAGES;
+
+    if (fraid == 5 && m_regionalgrid)
+    {
+        for (const std::size_t first : D2_IONOSPHERE_BLOCK_FIRSTPAGE)
+        {
+            if (pnum >= first && pnum < first + D2_IONOSPHERE_BLOCK_SIZE)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace bnav
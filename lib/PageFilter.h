@@ -0,0 +1,39 @@
+#ifndef PAGEFILTER_H
+#define PAGEFILTER_H
+
+#include "Subframe.h"
+#include "SvID.h"
+
+namespace bnav
+{
+
+/// Products which can be generated from the navigation message
+enum class Product
+{
+    KLOBUCHAR,
+    REGIONAL_GRID
+};
+
+/**
+ * @brief The PageFilter class
+ *
+ * Decides by FraID and Pnum whether a page is needed by any of the enabled
+ * products. Only the header of a Subframe has to be decoded for this.
+ */
+class PageFilter
+{
+    bool m_klobuchar;
+    bool m_regionalgrid;
+
+public:
+    PageFilter();
+
+    void enableProduct(const Product product);
+    bool isProductEnabled(const Product product) const;
+
+    bool isRequired(const SvID &sv, const Subframe &sf) const;
+};
+
+} // namespace bnav
+
+#endif // PAGEFILTER_H
@@ -0,0 +1,178 @@
+#include "PageVoter.h"
+
+#include "BeiDou.h"
+#include "NavBitsECC.h"
+
+#include <cassert>
+#include <iostream>
+
+namespace
+{
+
+/// words 1 and 2 carry the SOW, they differ with every copy
+constexpr std::size_t FIRST_DATA_WORD = 2;
+
+/// data of frame 5 is the regional grid, all other pages carry ephemeris
+uint32_t lcl_getIssueInterval(const bnav::Subframe &sf)
+{
+    return sf.getFrameID() == 5 ? bnav::REGIONAL_GRID_UPDATE_INTERVAL : bnav::EPHEMERIS_UPDATE_INTERVAL;
+}
+
+/// check if the BCH syndromes of both subwords of a word are zero
+bool lcl_isValidWord(const bnav::NavBits<300> &bits, const std::size_t word)
+{
+    bnav::NavBits<30> wordbits;
+    for (std::size_t i = 0; i < 30; ++i)
+        wordbits.setLeft(i, bits.atLeft(word * 30 + i));
+
+    return !bnav::NavBitsECCWord<30>(wordbits).isModified();
+}
+
+}
+
+namespace bnav
+{
+
+PageVoter::PageHistory::PageHistory()
+    : copies()
+    , next(0)
+{
+}
+
+/**
+ * @brief PageVoter::PageVoter
+ * @param depth Count of copies kept per page.
+ */
+PageVoter::PageVoter(const std::size_t depth)
+    : m_history()
+    , m_depth(depth)
+    , m_votedWordCount(0)
+    , m_repairedWordCount(0)
+{
+    assert(m_depth > 0);
+}
+
+/**
+ * @brief PageVoter::repair Vote the corrected data words of a page and keep
+ * the page as received for later votes.
+ *
+ * A word is voted only with at least two matching copies, on a tie of a bit
+ * the page keeps its own one. The voted word replaces the received one only
+ * if it is a valid BCH code word, otherwise the copies share the same wrong
+ * correction and the page keeps its word.
+ *
+ * @param sv The SvID.
+ * @param sf Fully initialized Subframe, voted words are replaced.
+ */
+void PageVoter::repair(const SvID &sv, Subframe &sf)
+{
+    const uint32_t key { (sf.getFrameID() << 8) | sf.getPageNum() };
+    PageHistory &history = m_history.insert(sv)[key];
+    const Subframe received { sf };
+
+    if (sf.getParityModifiedCount() != 0)
+    {
+        std::vector<const Subframe*> voters;
+        for (const Subframe &copy : history.copies)
+        {
+            if (isSameData(received, copy))
+                voters.push_back(&copy);
+        }
+
+        if (voters.size() >= 2)
+        {
+            NavBits<300> voted { received.getBits() };
+            for (std::size_t word = FIRST_DATA_WORD; word < SUBFRAME_WORDS; ++word)
+            {
+                if (received.getWordModifiedCount(word) == 0)
+                    continue;
+
+                ++m_votedWordCount;
+                bool changed = false;
+                for (std::size_t i = word * 30; i < (word + 1) * 30; ++i)
+                {
+                    std::size_t ones { received.getBits().atLeft(i) ? 1u : 0u };
+                    for (const Subframe *copy : voters)
+                        ones += copy->getBits().atLeft(i) ? 1u : 0u;
+
+                    const std::size_t zeros { voters.size() + 1 - ones };
+                    if (ones != zeros)
+                    {
+                        const bool bit { ones > zeros };
+                        changed = changed || bit != received.getBits().atLeft(i);
+                        voted.setLeft(i, bit);
+                    }
+                }
+
+                if (!lcl_isValidWord(voted, word))
+                    continue;
+
+                sf.replaceWord(word, voted);
+                if (changed)
+                    ++m_repairedWordCount;
+            }
+        }
+    }
+
+    // keep the page as received, so each copy votes only once
+    if (history.copies.size() < m_depth)
+    {
+        history.copies.push_back(received);
+    }
+    else
+    {
+        history.copies[history.next] = received;
+        history.next = (history.next + 1) % m_depth;
+    }
+}
+
+/**
+ * @brief PageVoter::isSameData Check if a copy carries the same data as the
+ * page.
+ *
+ * The copy has to be of the same update interval as the page, the data may
+ * have changed with the interval.
+ *
+ * @param sf The page.
+ * @param copy Older copy of the page.
+ * @return true, if all data words, which the page received without
+ * corrections, are equal in the copy.
+ */
+bool PageVoter::isSameData(const Subframe &sf, const Subframe &copy) const
+{
+    const uint32_t interval { lcl_getIssueInterval(sf) };
+    if (sf.getSOW() / interval != copy.getSOW() / interval)
+        return false;
+
+    for (std::size_t word = FIRST_DATA_WORD; word < SUBFRAME_WORDS; ++word)
+    {
+        if (sf.getWordModifiedCount(word) != 0)
+            continue;
+
+        for (std::size_t i = word * 30; i < (word + 1) * 30; ++i)
+        {
+            if (sf.getBits().atLeft(i) != copy.getBits().atLeft(i))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+std::size_t PageVoter::getVotedWordCount() const
+{
+    return m_votedWordCount;
+}
+
+std::size_t PageVoter::getRepairedWordCount() const
+{
+    return m_repairedWordCount;
+}
+
+void PageVoter::dump() const
+{
+    std::cout << "Page vote: " << m_votedWordCount << " voted words, "
+              << m_repairedWordCount << " repaired words" << std::endl;
+}
+
+} // namespace bnav
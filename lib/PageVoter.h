@@ -0,0 +1,60 @@
+#ifndef PAGEVOTER_H
+#define PAGEVOTER_H
+
+#include "Subframe.h"
+#include "SvArray.h"
+#include "SvID.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The PageVoter class
+ *
+ * Repairs pages by majority vote across their repetitions. Ionosphere and
+ * Klobuchar pages are repeated with every superframe until the data changes.
+ *
+ * BCH(15,11,1) turns a double error into a wrong single bit correction, so
+ * every corrected data word is a suspect. Its bits are voted with the last
+ * copies of the same page (FraID and Pnum). Only copies of the same update
+ * interval, whose data words are equal to the clean ones of the page, take
+ * part, so copies of older data don't vote even if the changed word is the
+ * corrected one. Words 1 and 2 carry the SOW and are never voted.
+ */
+class PageVoter
+{
+    /// last received copies of one page, ring buffer
+    struct PageHistory
+    {
+        std::vector<Subframe> copies;
+        std::size_t next; ///< slot of the next copy
+
+        PageHistory();
+    };
+
+    SvArray< std::map<uint32_t, PageHistory> > m_history;
+    std::size_t m_depth;
+    std::size_t m_votedWordCount;
+    std::size_t m_repairedWordCount;
+
+public:
+    PageVoter(const std::size_t depth = 4);
+
+    void repair(const SvID &sv, Subframe &sf);
+
+    std::size_t getVotedWordCount() const;
+    std::size_t getRepairedWordCount() const;
+
+    void dump() const;
+
+private:
+    bool isSameData(const Subframe &sf, const Subframe &copy) const;
+};
+
+} // namespace bnav
+
+#endif // PAGEVOTER_H
@@ -0,0 +1,159 @@
+#include "SlantDelayEvaluator.h"
+
+#include "BeiDou.h"
+#include "KlobucharEvaluator.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+
+/// delay of an unavailable line of sight
+constexpr double UNAVAILABLE_DELAY = 9999.0;
+
+constexpr double DEG2RAD = bnav::PI / 180.0;
+constexpr double RAD2DEG = 180.0 / bnav::PI;
+
+/// ratio of earth radius to radius of the ionospheric layer
+constexpr double LAYER_RATIO = bnav::BDS_EARTH_RADIUS / (bnav::BDS_EARTH_RADIUS + bnav::BDS_IONOSPHERE_HEIGHT);
+
+double lcl_convertTECUToMeter(const double value, const double freq)
+{
+    // inverse of the IonoGridInfo conversion, value is 0.1 TECU
+    return value / 10.0 * 1.0e16 * 40.3 / (freq * freq);
+}
+
+}
+
+namespace bnav
+{
+
+SlantDelayEvaluator::SlantDelayEvaluator()
+    : m_latitude()
+    , m_longitude()
+    , m_slantfactor()
+    , m_vertical()
+{
+}
+
+/**
+ * @brief SlantDelayEvaluator::evaluate Evaluate a Klobuchar model along each
+ * line of sight.
+ * @param klob Klobuchar parameters.
+ * @param los Lines of sight.
+ * @param delay B1I delay of each line of sight [m], 9999 if the SV is not
+ * above the horizon.
+ * @return Count of available delays.
+ */
+std::size_t SlantDelayEvaluator::evaluate(const KlobucharParam &klob, const LinesOfSight &los, std::vector<double> &delay)
+{
+    computePiercePoints(los);
+
+    const KlobucharEvaluator evaluator(klob);
+    const std::size_t count { los.size() };
+    delay.assign(count, UNAVAILABLE_DELAY);
+
+    std::size_t available = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (!(m_slantfactor[i] > 0.0))
+            continue;
+
+        const uint32_t secofday { static_cast<uint32_t>(std::fmod(los.time[i], SECONDS_OF_A_DAY)) };
+        delay[i] = m_slantfactor[i] * evaluator.getVerticalDelay(secofday, m_latitude[i], m_longitude[i]);
+        ++available;
+    }
+
+    return available;
+}
+
+/**
+ * @brief SlantDelayEvaluator::evaluate Evaluate the regional grid along each
+ * line of sight.
+ * @param grid Grids around the time of the lines of sight.
+ * @param los Lines of sight.
+ * @param delay B1I delay of each line of sight [m], 9999 if the SV is not
+ * above the horizon or the grid has no value at the pierce point.
+ * @return Count of available delays.
+ */
+std::size_t SlantDelayEvaluator::evaluate(IonosphereInterpolator &grid, const LinesOfSight &los, std::vector<double> &delay)
+{
+    computePiercePoints(los);
+    grid.evaluate(m_latitude, m_longitude, los.time, m_vertical);
+
+    const std::size_t count { los.size() };
+    delay.assign(count, UNAVAILABLE_DELAY);
+
+    std::size_t available = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (!(m_slantfactor[i] > 0.0) || !(m_vertical[i] < UNAVAILABLE_DELAY))
+            continue;
+
+        delay[i] = m_slantfactor[i] * lcl_convertTECUToMeter(m_vertical[i], BDS_B1I_FREQ);
+        ++available;
+    }
+
+    return available;
+}
+
+/// latitude of each pierce point of the last batch [deg]
+const std::vector<double>& SlantDelayEvaluator::getPierceLatitude() const
+{
+    return m_latitude;
+}
+
+/// longitude of each pierce point of the last batch [deg]
+const std::vector<double>& SlantDelayEvaluator::getPierceLongitude() const
+{
+    return m_longitude;
+}
+
+/// slant factor of each line of sight of the last batch, 0 below the horizon
+const std::vector<double>& SlantDelayEvaluator::getSlantFactor() const
+{
+    return m_slantfactor;
+}
+
+/**
+ * @brief SlantDelayEvaluator::computePiercePoints Compute pierce point and
+ * slant factor of each line of sight.
+ *
+ * One loop without branches over separate arrays, so the compiler may
+ * vectorize it.
+ *
+ * References:
+ * [1] ICD, 5.2.4.7 Ionospheric Delay Model Parameters, pp. 25
+ */
+void SlantDelayEvaluator::computePiercePoints(const LinesOfSight &los)
+{
+    const std::size_t count { los.size() };
+    assert(los.longitude.size() == count && los.azimuth.size() == count
+           && los.elevation.size() == count && los.time.size() == count);
+
+    m_latitude.resize(count);
+    m_longitude.resize(count);
+    m_slantfactor.resize(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const double phiu { los.latitude[i] * DEG2RAD };
+        const double azimuth { los.azimuth[i] * DEG2RAD };
+        const double elevation { los.elevation[i] * DEG2RAD };
+
+        // earth central angle between receiver and pierce point
+        const double ratio { LAYER_RATIO * std::cos(elevation) };
+        const double psi { PI / 2.0 - elevation - std::asin(ratio) };
+
+        const double phim { std::asin(std::sin(phiu) * std::cos(psi) + std::cos(phiu) * std::sin(psi) * std::cos(azimuth)) };
+        const double lambdam { los.longitude[i] + std::asin(std::sin(psi) * std::sin(azimuth) / std::cos(phim)) * RAD2DEG };
+
+        m_latitude[i] = phim * RAD2DEG;
+        // west of Greenwich is negative
+        m_longitude[i] = lambdam - 360.0 * std::floor((lambdam + 180.0) / 360.0);
+        m_slantfactor[i] = los.elevation[i] > 0.0 ? 1.0 / std::sqrt(1.0 - ratio * ratio) : 0.0;
+    }
+}
+
+} // namespace bnav
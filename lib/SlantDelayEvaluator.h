@@ -0,0 +1,59 @@
+#ifndef SLANTDELAYEVALUATOR_H
+#define SLANTDELAYEVALUATOR_H
+
+#include "Ephemeris.h"
+#include "IonosphereInterpolator.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace bnav
+{
+
+/// lines of sight from receivers to SVs, one entry per observation
+struct LinesOfSight
+{
+    std::vector<double> latitude; ///< of the receiver [deg]
+    std::vector<double> longitude; ///< of the receiver [deg]
+    std::vector<double> azimuth; ///< of the SV [deg]
+    std::vector<double> elevation; ///< of the SV [deg]
+    std::vector<double> time; ///< see IonosphereInterpolator::getTime()
+
+    std::size_t size() const { return latitude.size(); }
+};
+
+/**
+ * @brief The SlantDelayEvaluator class
+ *
+ * Evaluates the B1I delay along batches of lines of sight. The pierce point
+ * of each line of sight with the ionospheric layer at 375 km and its slant
+ * factor are computed as in the ICD, then the vertical delay at the pierce
+ * point is taken from a Klobuchar model or the regional grid.
+ *
+ * The delays are in meters, 9999 if not available.
+ */
+class SlantDelayEvaluator
+{
+    // pierce points of the last batch, reused
+    std::vector<double> m_latitude;
+    std::vector<double> m_longitude;
+    std::vector<double> m_slantfactor;
+    std::vector<double> m_vertical;
+
+public:
+    SlantDelayEvaluator();
+
+    std::size_t evaluate(const KlobucharParam &klob, const LinesOfSight &los, std::vector<double> &delay);
+    std::size_t evaluate(IonosphereInterpolator &grid, const LinesOfSight &los, std::vector<double> &delay);
+
+    const std::vector<double>& getPierceLatitude() const;
+    const std::vector<double>& getPierceLongitude() const;
+    const std::vector<double>& getSlantFactor() const;
+
+private:
+    void computePiercePoints(const LinesOfSight &los);
+};
+
+} // namespace bnav
+
+#endif // SLANTDELAYEVALUATOR_H
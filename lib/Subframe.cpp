@@ -3,7 +3,9 @@
 #include "BeiDou.h"
 #include "NavBitsECC.h"
 
+#include <bitset>
 #include <cassert>
+#include <functional>
 #include <iostream>
 #include <limits>
 
@@ -16,6 +18,7 @@
         std::cout << "Parity fixed at " << pos << ", 30" << std::endl; \
         m_bits.setLeft(pos, ecc.getBits()); \
         m_ParityModifiedCount += ecc.getModifiedCount(); \
+        m_wordModifiedCount[pos / 30] = static_cast<uint8_t>(ecc.getModifiedCount()); \
     }
 
 namespace bnav
@@ -35,6 +38,7 @@ Subframe::Subframe()
     , m_isGeo(false)
     , m_isParityFixed(false)
     , m_ParityModifiedCount(0)
+    , m_wordModifiedCount()
     , m_isInitialized(false)
 {
 }
@@ -47,6 +51,7 @@ Subframe::Subframe(const SvID &sv, const NavBits<300> &bits)
     , m_isGeo(sv.isGeo())
     , m_isParityFixed(false)
     , m_ParityModifiedCount(0)
+    , m_wordModifiedCount()
     , m_isInitialized(false)
 {
     initialize();
@@ -64,27 +69,83 @@ Subframe::Subframe(const SvID &sv, const NavBits<300> &bits)
  * 4. Decode Pnum.
  */
 void Subframe::initialize()
+{
+    initializeHeader();
+    initializeData();
+}
+
+/**
+ * @brief Subframe::initializeHeader Decode the header only.
+ *
+ * FraID, SOW and Pnum are within the first two words. Only these words get
+ * parity checked. Use initializeData() to fix the remaining words.
+ */
+void Subframe::initializeHeader()
+{
+    if (m_isGeo)
+        initializeHeaderD2();
+    else
+        initializeHeaderD1();
+}
+
+/**
+ * @brief Subframe::initializeHeaderD1 Decode the header of a D1 subframe.
+ *
+ * Same as initializeHeader(), for callers which already know the message
+ * type of the SV.
+ */
+void Subframe::initializeHeaderD1()
+{
+    m_isGeo = false;
+    decodeHeader();
+    parsePageNumD1();
+
+    m_isInitialized = true;
+}
+
+/**
+ * @brief Subframe::initializeHeaderD2 Decode the header of a D2 subframe.
+ *
+ * Same as initializeHeader(), for callers which already know the message
+ * type of the SV.
+ */
+void Subframe::initializeHeaderD2()
+{
+    m_isGeo = true;
+    decodeHeader();
+    parsePageNumD2();
+
+    m_isInitialized = true;
+}
+
+/**
+ * @brief Subframe::decodeHeader Check preamble, fix words 1 and 2 and read
+ * FraID and SOW, which are the same for D1 and D2.
+ */
+void Subframe::decodeHeader()
 {
     if (!isPreambleOk())
         std::cerr << "Wrong preamble: " << m_bits << std::endl;
 
-    // fix all remaining words
-    // other than the ICD says, there are no blocks like D2 subframe 4, which
-    // has 72 parity bits at the end of the message. Those pages are as all
-    // other, 30+30+30... (sbf and jps data!).
-    checkAndFixParities();
+    checkAndFixHeaderParities();
 
     // read basic info from NavBits
     parseFrameID();
     parseSOW();
+}
 
-    // no parity check before, because of special pages...
-    if (m_isGeo)
-        parsePageNumD2();
-    else
-        parsePageNumD1();
+/**
+ * @brief Subframe::initializeData Fix all words after the header.
+ *
+ * Other than the ICD says, there are no blocks like D2 subframe 4, which
+ * has 72 parity bits at the end of the message. Those pages are as all
+ * other, 30+30+30... (sbf and jps data!).
+ */
+void Subframe::initializeData()
+{
+    assert(m_isInitialized);
 
-    m_isInitialized = true;
+    checkAndFixDataParities();
 }
 
 void Subframe::setBits(const NavBits<300> &bits)
@@ -92,7 +153,7 @@ void Subframe::setBits(const NavBits<300> &bits)
     m_bits = bits;
 }
 
-NavBits<300> Subframe::getBits() const
+const NavBits<300>& Subframe::getBits() const
 {
     return m_bits;
 }
@@ -130,7 +191,83 @@ std::size_t Subframe::getParityModifiedCount() const
     return m_ParityModifiedCount;
 }
 
-bool Subframe::checkAndFixParities()
+/**
+ * @brief Subframe::getWordModifiedCount Number of fixed subwords of one word.
+ * @param word Index of the word, 0 to 9.
+ * @return Count of fixed subwords, 0 if the word was received correctly.
+ */
+std::size_t Subframe::getWordModifiedCount(const std::size_t word) const
+{
+    assert(word < SUBFRAME_WORDS);
+    return m_wordModifiedCount[word];
+}
+
+/**
+ * @brief Subframe::replaceWord Take one word from another copy of this
+ * subframe.
+ *
+ * Used to repair words with the copy of another signal, which needed less
+ * parity corrections for this word.
+ *
+ * @param word Index of the word, 0 to 9.
+ * @param other Copy of the same subframe, fully initialized.
+ */
+void Subframe::replaceWord(const std::size_t word, const Subframe &other)
+{
+    assert(word < SUBFRAME_WORDS);
+    assert(isSameMessage(other));
+
+    const std::size_t start { word * 30 };
+    for (std::size_t i = start; i < start + 30; ++i)
+        m_bits.setLeft(i, other.m_bits.atLeft(i));
+
+    m_ParityModifiedCount -= m_wordModifiedCount[word];
+    m_ParityModifiedCount += other.m_wordModifiedCount[word];
+    m_wordModifiedCount[word] = other.m_wordModifiedCount[word];
+}
+
+/**
+ * @brief Subframe::replaceWord Set one word to voted bits, e.g. the majority
+ * of several copies. The word counts as received without corrections then.
+ *
+ * @param word Index of the word, 0 to 9.
+ * @param bits Bits of a whole subframe, only the word is taken.
+ */
+void Subframe::replaceWord(const std::size_t word, const NavBits<300> &bits)
+{
+    assert(word < SUBFRAME_WORDS);
+
+    const std::size_t start { word * 30 };
+    for (std::size_t i = start; i < start + 30; ++i)
+        m_bits.setLeft(i, bits.atLeft(i));
+
+    m_ParityModifiedCount -= m_wordModifiedCount[word];
+    m_wordModifiedCount[word] = 0;
+}
+
+/**
+ * @brief Subframe::isSameMessage Check if both subframes carry the same
+ * message, e.g. the copies of B1 and B2.
+ * @return true if SOW, FraID and Pnum are equal.
+ */
+bool Subframe::isSameMessage(const Subframe &other) const
+{
+    return (getSOW() == other.getSOW())
+            && (getFrameID() == other.getFrameID())
+            && (getPageNum() == other.getPageNum());
+}
+
+/**
+ * @brief Subframe::getHash Hash of SOW and the corrected bits.
+ * @return Same hash for subframes, which are equal by operator==.
+ */
+std::size_t Subframe::getHash() const
+{
+    const std::size_t bitshash { std::hash< std::bitset<300> >()(m_bits.getBits()) };
+    return bitshash ^ (std::hash<uint32_t>()(m_sow) + 0x9e3779b9 + (bitshash << 6) + (bitshash >> 2));
+}
+
+void Subframe::checkAndFixHeaderParities()
 {
     // second 15 bits of word one need to be checked
     // first 15 bits are preamble and 4 bit reserved
@@ -142,11 +279,18 @@ bool Subframe::checkAndFixParities()
         std::cout << "Subframe: Parity fixed for SOW: " << m_sow << std::endl;
         m_bits.setLeft(15, ecc1.getBits());
         m_ParityModifiedCount += ecc1.getModifiedCount();
+        m_wordModifiedCount[0] = static_cast<uint8_t>(ecc1.getModifiedCount());
     }
 
-    // fix remaining words
+    // word two holds the rest of SOW and Pnum
     NavBitsECCWord<30> ecc(0);
     CHECK_PARITY_FOR_WORD(30)
+}
+
+void Subframe::checkAndFixDataParities()
+{
+    // fix remaining words
+    NavBitsECCWord<30> ecc(0);
     CHECK_PARITY_FOR_WORD(60)
     CHECK_PARITY_FOR_WORD(90)
     CHECK_PARITY_FOR_WORD(120)
@@ -156,8 +300,7 @@ bool Subframe::checkAndFixParities()
     CHECK_PARITY_FOR_WORD(240)
     CHECK_PARITY_FOR_WORD(270)
 
-    m_isParityFixed= true;
-    return m_isParityFixed;
+    m_isParityFixed = true;
 }
 
 /**
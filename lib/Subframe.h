@@ -4,15 +4,23 @@
 #include "NavBits.h"
 #include "SvID.h"
 
+#include <array>
 #include <cstdint>
 
 namespace bnav
 {
 
+/// A subframe is made up of ten words with 30 bits each
+constexpr std::size_t SUBFRAME_WORDS = 10;
+
 /**
  * @brief The Subframe class
  *
  * Forms a subframe. Does decoding of FraID, Pnum and SOW.
+ *
+ * Decoding can be split into the header (words 1 and 2) and the remaining
+ * data words, so pages which are not needed can be dropped without
+ * correcting all of their words.
  */
 class Subframe
 {
@@ -24,6 +32,7 @@ class Subframe
 
     bool m_isParityFixed;
     std::size_t m_ParityModifiedCount;
+    std::array<uint8_t, SUBFRAME_WORDS> m_wordModifiedCount;
     bool m_isInitialized;
 
 public:
@@ -31,23 +40,35 @@ public:
     Subframe(const SvID &sv, const NavBits<300> &bits);
 
     void setBits(const NavBits<300> &bits);
-    NavBits<300> getBits() const;
+    const NavBits<300>& getBits() const;
     std::size_t getParityModifiedCount() const;
+    std::size_t getWordModifiedCount(const std::size_t word) const;
+    void replaceWord(const std::size_t word, const Subframe &other);
+    void replaceWord(const std::size_t word, const NavBits<300> &bits);
 
     void setSvID(const SvID &sv);
     void setPageNum(const std::size_t pnum);
 
     void initialize();
+    void initializeHeader();
+    void initializeHeaderD1();
+    void initializeHeaderD2();
+    void initializeData();
 
     uint32_t getSOW() const;
     uint32_t getFrameID() const;
     uint32_t getPageNum() const;
 
+    bool isSameMessage(const Subframe &other) const;
+    std::size_t getHash() const;
+
     bool operator==(const Subframe &rhs);
 
 private:
+    void decodeHeader();
     bool isPreambleOk() const;
-    bool checkAndFixParities();
+    void checkAndFixHeaderParities();
+    void checkAndFixDataParities();
 
     void parseSOW();
     void parseFrameID();
@@ -1,76 +1,199 @@
 #include "SubframeBuffer.h"
 #include "BeiDou.h"
 
+#include <limits>
+
 namespace bnav
 {
 
 /**
- * @brief SubframeBuffer::SubframeBuffer
+ * @brief SubframeSlots::SubframeSlots
  *
- * Currently we only handle complete data sets. That means, pages have to be
- * complete and without gaps (SOW and Pnum cheched). Incomplete data sets
- * get discarded at the moment.
+ * All slots get allocated at construction, adding pages doesn't allocate.
  *
- * Data sets means Ephemeris, Almanac and Integrity data.
+ * @param capacity Page count of the data set, all of them are required.
+ * @param period Duration of the data set in seconds, data sets start at
+ * multiples of it.
  */
+SubframeSlots::SubframeSlots(const std::size_t capacity, const uint32_t period)
+    : m_slots(capacity)
+    , m_received()
+    , m_required()
+    , m_period(period)
+    , m_epoch(std::numeric_limits<uint32_t>::max())
+    , m_isFlushed(false)
+{
+    assert(capacity <= SUBFRAMESLOTS_MAX);
+    assert(period > 0);
 
-SubframeBuffer::SubframeBuffer()
-    : m_lastsow(0)
+    for (std::size_t i = 0; i < capacity; ++i)
+        m_required.set(i);
+}
+
+/**
+ * @brief SubframeSlots::add Put a page into its slot.
+ *
+ * A page with a newer epoch than the current data set starts a new data set.
+ * Pages of older data sets and pages whose epoch is not at the start of a
+ * data set (corrupted Pnum or SOW) are ignored, so they can't discard the
+ * current one. If a slot is already filled, the copy with fewer parity
+ * corrections is kept.
+ *
+ * @param slot Index of the page inside the data set.
+ * @param epoch SOW of the first page of the data set the page belongs to.
+ * @param sf The page.
+ * @return true, if an incomplete data set got dropped by this page.
+ */
+bool SubframeSlots::add(const std::size_t slot, const uint32_t epoch, const Subframe &sf)
+{
+    assert(slot < m_slots.size());
+    bool dropped = false;
+
+    if (epoch % m_period != 0)
+    {
+        std::cout << "Warning: SubframeBuffer: Subframe " << sf.getFrameID()
+                  << " Pnum (" << sf.getPageNum() << ") at SOW " << sf.getSOW()
+                  << " doesn't start at a data set boundary!" << std::endl;
+        return dropped;
+    }
+
+    if (epoch != m_epoch)
+    {
+        if (isOlder(epoch))
+            return dropped;
+
+        // page belongs to the next data set, forget about the current one
+        dropped = hasIncompleteData();
+        m_received.reset();
+        m_epoch = epoch;
+        m_isFlushed = false;
+    }
+
+    // data set was already handed over, this is a retransmission
+    if (m_isFlushed)
+        return dropped;
+
+    if (m_received[slot]
+            && m_slots[slot].getParityModifiedCount() <= sf.getParityModifiedCount())
+        return dropped;
+
+    m_slots[slot] = sf;
+    m_received.set(slot);
+
+    return dropped;
+}
+
+/**
+ * @brief SubframeSlots::isComplete Check if all required pages are present.
+ * @return true, if complete and not flushed yet.
+ */
+bool SubframeSlots::isComplete() const
 {
-    // reserve space for five subframes
-    m_buffer = SubframeVectorVector(5);
+    return !m_isFlushed && (m_received & m_required) == m_required;
 }
 
-SubframeBuffer::~SubframeBuffer()
+/**
+ * @brief SubframeSlots::hasIncompleteData Check if there are pages which
+ * are not handed over.
+ * @return true, if there is data.
+ */
+bool SubframeSlots::hasIncompleteData() const
 {
+    return !m_isFlushed && m_received.any();
 }
 
 /**
- * @brief SubframeBuffer::hasIncompleteData Checks if there is any dataset left.
+ * @brief SubframeSlots::lend Hand over pages of the data set without copying.
  *
- * Used to check if there is incomplete data inside the buffer.
+ * Marks the data set as flushed. Further pages of the same epoch are ignored,
+ * the returned view stays valid until the next page of a new epoch is added.
  *
- * @return true if there is data, false if empty.
+ * @param first Index of the first slot.
+ * @param count Number of slots.
+ * @return View onto the slots.
  */
-bool SubframeBuffer::hasIncompleteData()
+SubframeSpan SubframeSlots::lend(const std::size_t first, const std::size_t count)
 {
-    return m_buffer[0].size() > 0
-            || m_buffer[1].size() > 0
-            || m_buffer[2].size() > 0
-            || m_buffer[3].size() > 0
-            || m_buffer[4].size() > 0;
+    assert(first + count <= m_slots.size());
+
+    // ensure correct data sets, should not be possible!
+    for (std::size_t i = first; i < first + count; ++i)
+        assert(m_received[i]);
+
+    m_isFlushed = true;
+
+    return SubframeSpan(m_slots.data() + first, count);
 }
 
 /**
- * @brief SubframeBuffer::checkLastSOW Check if the current SOW fits to the last
- * one in the buffer.
- * @param currentsow Current SOW.
- * @param duration Duration of a Subframe.
+ * @brief SubframeSlots::isOlder Check if an epoch lies before the one of the
+ * current data set.
+ *
+ * SOW starts over at the week change, so an epoch more than half a week
+ * before the current one belongs to the next week.
+ *
+ * @param epoch SOW of the first page of a data set.
+ * @return true, if epoch is older than the current data set.
  */
-void SubframeBuffer::checkLastSOW(uint32_t currentsow, uint32_t duration)
+bool SubframeSlots::isOlder(const uint32_t epoch) const
 {
-    // special case: if last SOW is the last of the week
-    if ((m_lastsow + duration == SECONDS_OF_A_WEEK) && (currentsow == 0))
-    {
-        std::cout << "Warning: SubframeBuffer: Week change!" << std::endl;
+    if (m_epoch == std::numeric_limits<uint32_t>::max() || epoch >= m_epoch)
+        return false;
 
-        clearEphemerisData();
-        clearAlmanacData();
-        return;
-    }
+    return m_epoch - epoch < SECONDS_OF_A_WEEK / 2;
+}
 
-    // Last message SOW should fit the current one + 6s. So we can
-    // easily detect data gaps.
-    if ((m_lastsow + duration != currentsow) && (m_lastsow > 0))
-    {
-        std::cout << "Warning: SubframeBuffer: Data gap of "
-                  << currentsow - (m_lastsow + duration)
-                  << "s detected!" << std::endl;
+/**
+ * @brief SubframeSlots::clear Drop all pages of the current data set.
+ */
+void SubframeSlots::clear()
+{
+    m_received.reset();
+    m_isFlushed = false;
+}
 
-        // initialize new data sets, because the old are uncompleted
-        clearEphemerisData();
-        clearAlmanacData();
+/**
+ * @brief SubframeBuffer::SubframeBuffer
+ *
+ * Collects pages into data sets. Every page is put into its own slot, the
+ * pages of one data set have to belong to the same epoch (SOW checked).
+ * Gaps, duplicates or out of order pages don't discard other data sets.
+ * Data sets which don't complete until the next epoch get discarded.
+ *
+ * Data sets means Ephemeris, Almanac and Integrity data.
+ */
+SubframeBuffer::SubframeBuffer()
+{
+}
+
+SubframeBuffer::~SubframeBuffer()
+{
+}
+
+/**
+ * @brief SubframeBuffer::calcEpoch Calculate the SOW of the first page of
+ * the data set, a Subframe belongs to.
+ * @param sf The Subframe.
+ * @param offset Seconds between the first page of the data set and sf.
+ * @param epoch SOW of the data set.
+ * @return false, if Subframe doesn't fit into the week.
+ */
+bool SubframeBuffer::calcEpoch(const Subframe &sf, const uint32_t offset, uint32_t &epoch) const
+{
+    const uint32_t sow { sf.getSOW() };
+
+    // data sets never span a week change, so this can only happen with
+    // a corrupted Pnum
+    if (offset > sow)
+    {
+        std::cout << "Warning: SubframeBuffer: Subframe " << sf.getFrameID()
+                  << " Pnum (" << sf.getPageNum() << ") doesn't fit to SOW "
+                  << sow << "!" << std::endl;
+        return false;
     }
+
+    epoch = sow - offset;
+    return true;
 }
 
 } // namespace bnav
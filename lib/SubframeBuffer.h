@@ -3,6 +3,10 @@
 
 #include "Subframe.h"
 
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <initializer_list>
 #include <vector>
 
 namespace bnav
@@ -18,42 +22,140 @@ enum class SubframeBufferType
     D2_EPHEMERIS,
     D2_INTEGRITY,
     D2_ALMANAC,
+    D2_IONOSPHERE,
     NONE
 };
 
+/// Pages of the ephemeris data set a SubframeBuffer collects
+enum class EphemerisPages
+{
+    ALL, ///< D1 subframes 1 to 3, all 10 pages of D2 frame 1
+    KLOBUCHAR ///< only WN, SOW and Klobuchar: D1 subframe 1, D2 frame 1 pages 1 and 2
+};
+
+/// Pages of D2 frame 5 a SubframeBufferD2 collects
+enum class D2AlmanacPages
+{
+    ALL, ///< all 120 pages
+    IONOSPHERE ///< only both IGP blocks, pages 1 to 13 and 61 to 73
+};
+
+/**
+ * @brief The SubframeSpan class
+ *
+ * Non-owning view onto consecutive pages of one frame. The pages are lent by
+ * a SubframeBuffer and stay valid until the next call of addSubframe() on it.
+ */
+class SubframeSpan
+{
+    const Subframe *m_data;
+    std::size_t m_size;
+
+public:
+    SubframeSpan()
+        : m_data(nullptr)
+        , m_size(0)
+    {
+    }
+
+    SubframeSpan(const Subframe *data, const std::size_t size)
+        : m_data(data)
+        , m_size(size)
+    {
+    }
+
+    SubframeSpan(const SubframeVector &vec)
+        : m_data(vec.data())
+        , m_size(vec.size())
+    {
+    }
+
+    const Subframe* begin() const { return m_data; }
+    const Subframe* end() const { return m_data + m_size; }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    const Subframe& operator[](const std::size_t index) const
+    {
+        assert(index < m_size);
+        return m_data[index];
+    }
+
+    const Subframe& front() const { return (*this)[0]; }
+    const Subframe& back() const { return (*this)[m_size - 1]; }
+};
+
+/// D1 ephemeris data is made up of three subframes, all others of one frame
+constexpr std::size_t SUBFRAMEBUFFER_MAX_FRAMES = 3;
+
 /// Group together Subframe data and it's type
 struct SubframeBufferParam
 {
     SubframeBufferType type;
-    SubframeVectorVector data;
+    std::array<SubframeSpan, SUBFRAMEBUFFER_MAX_FRAMES> data;
+    std::size_t framecount;
 
     SubframeBufferParam()
         : type(SubframeBufferType::NONE)
-        , data(0)
+        , data()
+        , framecount(0)
     {
     }
 
-    SubframeBufferParam(SubframeBufferType rtype, const SubframeVectorVector &vec)
+    SubframeBufferParam(SubframeBufferType rtype, std::initializer_list<SubframeSpan> frames)
         : type(rtype)
-        , data(vec)
+        , data()
+        , framecount(0)
     {
+        assert(frames.size() <= SUBFRAMEBUFFER_MAX_FRAMES);
+        for (const SubframeSpan &frame : frames)
+            data[framecount++] = frame;
     }
 };
 
-class SubframeBuffer
+/// Largest data set: all 120 pages of D2 frame 5
+constexpr std::size_t SUBFRAMESLOTS_MAX = 120;
+
+/**
+ * @brief The SubframeSlots class
+ *
+ * Collects the pages of one data set into preallocated slots. The whole set
+ * is tagged with the SOW of its first page (epoch). Pages may arrive in any
+ * order and with gaps.
+ */
+class SubframeSlots
 {
-protected:
-    // save: frame< pages >
-    SubframeVectorVector m_buffer;
+    std::vector<Subframe> m_slots;
+    std::bitset<SUBFRAMESLOTS_MAX> m_received;
+    std::bitset<SUBFRAMESLOTS_MAX> m_required;
+    uint32_t m_period; ///< data sets start at multiples of this SOW
+    uint32_t m_epoch;
+    bool m_isFlushed;
+
+public:
+    SubframeSlots(const std::size_t capacity, const uint32_t period);
 
-    uint32_t m_lastsow;
+    bool add(const std::size_t slot, const uint32_t epoch, const Subframe &sf);
 
+    bool isComplete() const;
+    bool hasIncompleteData() const;
+
+    SubframeSpan lend(const std::size_t first, const std::size_t count);
+    void clear();
+
+private:
+    bool isOlder(const uint32_t epoch) const;
+};
+
+class SubframeBuffer
+{
 public:
     SubframeBuffer();
     virtual ~SubframeBuffer() = 0;
 
     virtual void addSubframe(const Subframe &sf) = 0;
-    bool hasIncompleteData();
+    virtual bool hasIncompleteData() const = 0;
 
     virtual bool isEphemerisComplete() const = 0;
     //virtual bool isIntegrityComplete() const = 0;
@@ -68,16 +170,21 @@ public:
     virtual void clearAlmanacData() = 0;
 
 protected:
-    void checkLastSOW(uint32_t currentsow, uint32_t duration);
+    bool calcEpoch(const Subframe &sf, const uint32_t offset, uint32_t &epoch) const;
 };
 
 class SubframeBufferD1 final : public SubframeBuffer
 {
+    EphemerisPages m_ephemerispages;
+    SubframeSlots m_ephemeris; ///< subframes 1 to 3
+    SubframeSlots m_almanac; ///< pages of subframe 4 and 5
+
 public:
-    SubframeBufferD1();
+    SubframeBufferD1(const EphemerisPages ephpages = EphemerisPages::ALL);
     ~SubframeBufferD1() override;
 
     void addSubframe(const Subframe &sf) override;
+    bool hasIncompleteData() const override;
 
     bool isEphemerisComplete() const override;
     bool isAlmanacComplete() const override;
@@ -91,11 +198,18 @@ public:
 
 class SubframeBufferD2 final : public SubframeBuffer
 {
+    EphemerisPages m_ephemerispages;
+    D2AlmanacPages m_almanacpages;
+    SubframeSlots m_ephemeris; ///< pages of frame 1
+    SubframeSlots m_almanac; ///< pages of frame 5
+
 public:
-    SubframeBufferD2();
+    SubframeBufferD2(const D2AlmanacPages pages = D2AlmanacPages::ALL,
+                     const EphemerisPages ephpages = EphemerisPages::ALL);
     ~SubframeBufferD2() override;
 
     void addSubframe(const Subframe &sf) override;
+    bool hasIncompleteData() const override;
 
     bool isEphemerisComplete() const override;
     bool isAlmanacComplete() const override;
@@ -105,6 +219,9 @@ public:
 
     void clearEphemerisData() override;
     void clearAlmanacData() override;
+
+private:
+    bool getAlmanacSlot(const std::size_t pnum, std::size_t &slot) const;
 };
 
 } // namespace bnav
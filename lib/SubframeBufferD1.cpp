@@ -1,12 +1,24 @@
 #include "BeiDou.h"
 #include "SubframeBuffer.h"
 
-// TODO: this is D1 only at the moment
-
 namespace bnav
 {
 
-SubframeBufferD1::SubframeBufferD1()
+/**
+ * @brief SubframeBufferD1::SubframeBufferD1
+ *
+ * With EphemerisPages::KLOBUCHAR only subframe 1 is kept, it carries WN, SOW
+ * and the Klobuchar parameters. The ephemeris data set is then complete six
+ * seconds after the start of the frame and consists of one subframe only.
+ *
+ * @param ephpages Subframes of the ephemeris data set to collect.
+ */
+SubframeBufferD1::SubframeBufferD1(const EphemerisPages ephpages)
+    : m_ephemerispages(ephpages)
+    , m_ephemeris(ephpages == EphemerisPages::KLOBUCHAR ? D1_FRAME_SIZE[0]
+                                                       : D1_FRAME_SIZE[0] + D1_FRAME_SIZE[1] + D1_FRAME_SIZE[2],
+                  D1_FRAME_DURATION)
+    , m_almanac(D1_FRAME_SIZE[3] + D1_FRAME_SIZE[4], D1_SUPERFRAME_DURATION)
 {
 }
 
@@ -19,8 +31,8 @@ SubframeBufferD1::~SubframeBufferD1()
  *
  * Collects all subframes, until a message type is complete.
  *
- * Attention: If you don't fetch a completeted data set before adding a
- * new subframe, this data set will be dropped.
+ * Attention: If you don't fetch a completeted data set before the first
+ * subframe of the next data set is added, this data set will be dropped.
  *
  * @param sf Subframe to add to the buffer.
  */
@@ -28,53 +40,53 @@ void SubframeBufferD1::addSubframe(const Subframe &sf)
 {
     const std::size_t fraid { sf.getFrameID() };
     const std::size_t pnum { sf.getPageNum() };
-    const uint32_t sow { sf.getSOW() };
+    uint32_t epoch;
 
-    checkLastSOW(sow, D1_SUBFRAME_DURATION);
-    m_lastsow = sow;
-
-    // if we hit the beginning of frame1, start collecting ephemeris data
-    if (fraid == 1 && pnum == 0 && m_buffer[0].size() > 0)
+    // subframes 1 to 3 of one frame contain ephemeris data
+    if (fraid <= 3)
     {
-        std::cout << "SubframeBuffer: Auto clear of incomplete ephemeris data set" << std::endl;
-        clearEphemerisData();
-    }
+        if (m_ephemerispages == EphemerisPages::KLOBUCHAR && fraid > 1)
+            return;
 
-    // if we hit the beginning of frame4, start collecting almanac data
-    // this means auto clear of old almanac data
-    if (fraid == 4 && pnum == 1 && m_buffer[3].size() > 0)
-    {
-        std::cout << "SubframeBuffer: Auto clear of incomplete alamanac data set" << std::endl;
-        clearAlmanacData();
+        if (!calcEpoch(sf, static_cast<uint32_t>(fraid - 1) * D1_SUBFRAME_DURATION, epoch))
+            return;
+
+        if (m_ephemeris.add(fraid - 1, epoch, sf))
+            std::cout << "SubframeBuffer: Auto clear of incomplete ephemeris data set" << std::endl;
+
+        return;
     }
 
     // D1: Only Subframes 4 and 5 have Pnum
-    // new Pnum has to be bigger than the previous one of the same subframe
-    // this proves a valid data set (continuous Pnum of a subframe), including
-    // the correct length (because 24 + 1 == 24, isn't possible).
-    if (fraid > 3
-            && m_buffer[fraid - 1].size()
-            && m_buffer[fraid - 1].back().getPageNum() + 1 != pnum)
+    if (pnum == 0 || pnum > D1_FRAME_SIZE[fraid - 1])
     {
-        std::cout << "Warning: SubframeBuffer: Pnum (" << pnum
-                  << ") doesn't fit to previous one("
-                  << m_buffer[fraid - 1].back().getPageNum()
-                  << ") for Subframe " << fraid << " at SOW "
-                  << sow << "!" << std::endl;
-
-        if (fraid == 1)
-        {
-            std::cout << "SubframeBuffer: Auto clear of incomplete ephemeris data set" << std::endl;
-            clearEphemerisData();
-        }
-        if (fraid == 4)
-        {
-            std::cout << "SubframeBuffer: Auto clear of incomplete alamanac data set" << std::endl;
-            clearAlmanacData();
-        }
+        std::cout << "Warning: SubframeBuffer: Invalid Pnum for Subframe "
+                  << fraid << " at SOW " << sf.getSOW() << "!" << std::endl;
+        return;
     }
 
-    m_buffer[fraid - 1].push_back(sf);
+    // Pnum changes with every frame, one superframe is 24 frames long
+    const uint32_t offset { static_cast<uint32_t>(pnum - 1) * D1_FRAME_DURATION
+                            + static_cast<uint32_t>(fraid - 1) * D1_SUBFRAME_DURATION };
+    if (!calcEpoch(sf, offset, epoch))
+        return;
+
+    // pages of subframe 5 follow those of subframe 4
+    const std::size_t slot { (fraid - 4) * D1_FRAME_SIZE[3] + pnum - 1 };
+    if (m_almanac.add(slot, epoch, sf))
+        std::cout << "SubframeBuffer: Auto clear of incomplete alamanac data set" << std::endl;
+}
+
+/**
+ * @brief SubframeBufferD1::hasIncompleteData Checks if there is any dataset left.
+ *
+ * Used to check if there is incomplete data inside the buffer.
+ *
+ * @return true if there is data, false if empty.
+ */
+bool SubframeBufferD1::hasIncompleteData() const
+{
+    return m_ephemeris.hasIncompleteData() || m_almanac.hasIncompleteData();
 }
 
 /**
@@ -84,10 +96,8 @@ void SubframeBufferD1::addSubframe(const Subframe &sf)
  */
 bool SubframeBufferD1::isEphemerisComplete() const
 {
-    // complete if we have subframes 1 to 3
-    return m_buffer[0].size() == D1_FRAME_SIZE[0]
-            && m_buffer[1].size() == D1_FRAME_SIZE[1]
-            && m_buffer[2].size() == D1_FRAME_SIZE[2];
+    // complete if we have subframes 1 to 3 (or only subframe 1)
+    return m_ephemeris.isComplete();
 }
 
 /**
@@ -98,55 +108,62 @@ bool SubframeBufferD1::isEphemerisComplete() const
 bool SubframeBufferD1::isAlmanacComplete() const
 {
     // complete if we have all pages of subframe 4 and 5
-    return m_buffer[3].size() == D1_FRAME_SIZE[3]
-            && m_buffer[4].size() == D1_FRAME_SIZE[4];
+    return m_almanac.isComplete();
 }
 
 /**
  * @brief SubframeBufferD1::flushEphemerisData Get Ephemeris data and clear the
  * buffer.
+ *
+ * The pages are lent, not copied. They stay valid until the next addSubframe().
+ *
  * @return Ephemeris data as SubframeBufferParam.
  */
 SubframeBufferParam SubframeBufferD1::flushEphemerisData()
 {
-    SubframeVectorVector ephdata;
+    assert(isEphemerisComplete());
 
     // D1: first, second and third frame contain ephemeris data
-    for (std::size_t i = 0; i <= 2; ++i)
-    {
-        ephdata.push_back(m_buffer[i]);
-
-        // ensure correct data sets, should not be possible!
-        // D1 ephemeris have no Pnum
-        assert(m_buffer[i].front().getPageNum() == 0);
-    }
-
-    clearEphemerisData();
-
-    return SubframeBufferParam(SubframeBufferType::D1_EPHEMERIS, ephdata);
+    const SubframeBufferParam ephdata = (m_ephemerispages == EphemerisPages::KLOBUCHAR)
+            ? SubframeBufferParam(SubframeBufferType::D1_EPHEMERIS,
+                                  { m_ephemeris.lend(0, 1) })
+            : SubframeBufferParam(SubframeBufferType::D1_EPHEMERIS,
+                                  { m_ephemeris.lend(0, 1),
+                                    m_ephemeris.lend(1, 1),
+                                    m_ephemeris.lend(2, 1) });
+
+    // ensure correct data sets, should not be possible!
+    // D1 ephemeris have no Pnum
+    for (std::size_t i = 0; i < ephdata.framecount; ++i)
+        assert(ephdata.data[i].front().getPageNum() == 0);
+
+    return ephdata;
 }
 
 /**
  * @brief SubframeBufferD1::flushAlmanacData Get Alamanc data and clear the
  * buffer.
+ *
+ * The pages are lent, not copied. They stay valid until the next addSubframe().
+ *
  * @return The Almanac data as SubframeBufferParam.
  */
 SubframeBufferParam SubframeBufferD1::flushAlmanacData()
 {
-    SubframeVectorVector almdata;
+    assert(isAlmanacComplete());
 
-    for (std::size_t i = 3; i <= 4; ++i)
-    {
-        almdata.push_back(m_buffer[i]);
+    const SubframeBufferParam almdata(SubframeBufferType::D1_ALMANAC,
+                                      { m_almanac.lend(0, D1_FRAME_SIZE[3]),
+                                        m_almanac.lend(D1_FRAME_SIZE[3], D1_FRAME_SIZE[4]) });
 
-        // ensure correct data sets, should not be possible!
-        assert(m_buffer[i].front().getPageNum() == 1);
-        assert(m_buffer[i].back().getPageNum() == D1_FRAME_SIZE[i]);
+    // ensure correct data sets, should not be possible!
+    for (std::size_t i = 0; i <= 1; ++i)
+    {
+        assert(almdata.data[i].front().getPageNum() == 1);
+        assert(almdata.data[i].back().getPageNum() == D1_FRAME_SIZE[i + 3]);
     }
 
-    clearAlmanacData();
-
-    return SubframeBufferParam(SubframeBufferType::D1_ALMANAC, almdata);
+    return almdata;
 }
 
 /**
@@ -155,9 +172,7 @@ SubframeBufferParam SubframeBufferD1::flushAlmanacData()
  */
 void SubframeBufferD1::clearEphemerisData()
 {
-    m_buffer[0].clear();
-    m_buffer[1].clear();
-    m_buffer[2].clear();
+    m_ephemeris.clear();
 }
 
 /**
@@ -166,8 +181,7 @@ void SubframeBufferD1::clearEphemerisData()
  */
 void SubframeBufferD1::clearAlmanacData()
 {
-    m_buffer[3].clear();
-    m_buffer[4].clear();
+    m_almanac.clear();
 }
 
 } // namespace bnav
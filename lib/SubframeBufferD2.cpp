@@ -4,7 +4,27 @@
 namespace bnav
 {
 
-SubframeBufferD2::SubframeBufferD2()
+/**
+ * @brief SubframeBufferD2::SubframeBufferD2
+ *
+ * With D2AlmanacPages::IONOSPHERE only the pages of frame 5 which carry the
+ * ionospheric grid are kept. The almanac data set is then complete as soon
+ * as both IGP blocks of one superframe are present and gets flushed as
+ * SubframeBufferType::D2_IONOSPHERE.
+ *
+ * With EphemerisPages::KLOBUCHAR only pages 1 and 2 of frame 1 are kept,
+ * which is enough for WN, SOW and the Klobuchar parameters.
+ *
+ * @param pages Pages of frame 5 to collect.
+ * @param ephpages Pages of frame 1 to collect.
+ */
+SubframeBufferD2::SubframeBufferD2(const D2AlmanacPages pages, const EphemerisPages ephpages)
+    : m_ephemerispages(ephpages)
+    , m_almanacpages(pages)
+    , m_ephemeris(ephpages == EphemerisPages::KLOBUCHAR ? D2_KLOBUCHAR_PAGES : D2_FRAME_SIZE[0],
+                  static_cast<uint32_t>(D2_FRAME_SIZE[0]) * D2_FRAME_DURATION)
+    , m_almanac(pages == D2AlmanacPages::IONOSPHERE ? 2 * D2_IONOSPHERE_BLOCK_SIZE : D2_FRAME_SIZE[4],
+                static_cast<uint32_t>(D2_FRAME_SIZE[4]) * D2_FRAME_DURATION)
 {
 }
 
@@ -17,8 +37,8 @@ SubframeBufferD2::~SubframeBufferD2()
  *
  * Collects all subframes, until a message type is complete.
  *
- * Attention: If you don't fetch a completeted data set before adding a
- * new subframe, this data set will be dropped.
+ * Attention: If you don't fetch a completeted data set before the first
+ * page of the next data set is added, this data set will be dropped.
  *
  * @param sf Subframe to add to the buffer.
  */
@@ -26,119 +46,167 @@ void SubframeBufferD2::addSubframe(const Subframe &sf)
 {
     const std::size_t fraid { sf.getFrameID() };
     const std::size_t pnum { sf.getPageNum() };
-    const uint32_t sow { sf.getSOW() };
-
-    if (fraid == 1)
-        checkLastSOW(sow, D2_FRAME_DURATION);
-    else
-    {
-        // D2 has the same SOW for all subframes of one frame, check this
-        if (m_lastsow != sow && m_lastsow > 0)
-        {
-            std::cout << "Warning: SubframeBuffer: Subframe at SOW "
-                      << sow << " has another "
-                      << "SOW than the current Frame!" << std::endl;
-
-            // initialize new data sets, because the old are uncompleted
-            clearEphemerisData();
-            clearAlmanacData();
-        }
-    }
-    m_lastsow = sow;
 
     // skip integrity data frames, this is not implemented
     // skip frame 4, as there is no data in it atm
     if (fraid > 1 && fraid < 5)
         return;
 
-    // if we hit the beginning of frame1, start collecting ephemeris data
-    if (fraid == 1 && pnum == 1 && m_buffer[0].size() > 0)
+    if (pnum == 0 || pnum > D2_FRAME_SIZE[fraid - 1])
     {
-        std::cout << "SubframeBuffer: Auto clear of incomplete ephemeris data set" << std::endl;
-        clearEphemerisData();
+        std::cout << "Warning: SubframeBuffer: Invalid Pnum for Subframe "
+                  << fraid << " at SOW " << sf.getSOW() << "!" << std::endl;
+        return;
     }
 
-    // if we hit the beginning of frame4, start collecting almanac data
-    // this means auto clear of old almanac data
-    if (fraid == 5 && pnum == 1 && m_buffer[4].size() > 0)
+    // D2 has the same SOW for all subframes of one frame, Pnum changes
+    // with every frame
+    uint32_t epoch;
+    if (!calcEpoch(sf, static_cast<uint32_t>(pnum - 1) * D2_FRAME_DURATION, epoch))
+        return;
+
+    if (fraid == 1)
+    {
+        if (m_ephemerispages == EphemerisPages::KLOBUCHAR && pnum > D2_KLOBUCHAR_PAGES)
+            return;
+
+        if (m_ephemeris.add(pnum - 1, epoch, sf))
+            std::cout << "SubframeBuffer: Auto clear of incomplete ephemeris data set" << std::endl;
+    }
+    else
     {
-        std::cout << "SubframeBuffer: Auto clear of incomplete alamanac data set" << std::endl;
-        clearAlmanacData();
+        // pages which are not collected don't get stored at all
+        std::size_t slot;
+        if (!getAlmanacSlot(pnum, slot))
+            return;
+
+        if (m_almanac.add(slot, epoch, sf))
+            std::cout << "SubframeBuffer: Auto clear of incomplete alamanac data set" << std::endl;
     }
+}
 
-    // New Pnum has to be bigger than the previous one of the same subframe.
-    // This proves a valid data set (continuous Pnum of a subframe), including
-    // the correct length (because 120 + 1 == 120, isn't possible).
-    if (m_buffer[fraid - 1].size() && m_buffer[fraid - 1].back().getPageNum() + 1 != pnum)
+/**
+ * @brief SubframeBufferD2::getAlmanacSlot Map Pnum of frame 5 to its slot.
+ * @param pnum Pnum of frame 5.
+ * @param slot Index of the slot.
+ * @return false, if the page isn't collected.
+ */
+bool SubframeBufferD2::getAlmanacSlot(const std::size_t pnum, std::size_t &slot) const
+{
+    if (m_almanacpages == D2AlmanacPages::ALL)
     {
-        std::cout << "Warning: SubframeBuffer: Pnum (" << pnum
-                  << ") doesn't fit to previous one("
-                  << m_buffer[fraid - 1].back().getPageNum()
-                  << ") for Subframe " << fraid << " at SOW "
-                  << sow << "!" << std::endl;
+        slot = pnum - 1;
+        return true;
+    }
 
-        if (fraid == 1)
-        {
-            std::cout << "SubframeBuffer: Auto clear of incomplete ephemeris data set" << std::endl;
-            clearEphemerisData();
-        }
-        if (fraid == 5)
+    // IGP blocks are stored one after another
+    for (std::size_t block = 0; block <= 1; ++block)
+    {
+        const std::size_t first { D2_IONOSPHERE_BLOCK_FIRSTPAGE[block] };
+        if (pnum >= first && pnum < first + D2_IONOSPHERE_BLOCK_SIZE)
         {
-            std::cout << "SubframeBuffer: Auto clear of incomplete alamanac data set" << std::endl;
-            clearAlmanacData();
+            slot = block * D2_IONOSPHERE_BLOCK_SIZE + pnum - first;
+            return true;
         }
     }
 
-    m_buffer[fraid - 1].push_back(sf);
+    return false;
+}
+
+/**
+ * @brief SubframeBufferD2::hasIncompleteData Checks if there is any dataset left.
+ *
+ * Used to check if there is incomplete data inside the buffer.
+ *
+ * @return true if there is data, false if empty.
+ */
+bool SubframeBufferD2::hasIncompleteData() const
+{
+    return m_ephemeris.hasIncompleteData() || m_almanac.hasIncompleteData();
 }
 
 bool SubframeBufferD2::isEphemerisComplete() const
 {
-    // complete if we have all pages of subframe 1
-    return m_buffer[0].size() == D2_FRAME_SIZE[0];
+    // complete if we have all collected pages of subframe 1
+    return m_ephemeris.isComplete();
 }
 
 bool SubframeBufferD2::isAlmanacComplete() const
 {
-    // complete if we have all pages of subframe 5
-    return m_buffer[4].size() == D2_FRAME_SIZE[4];
+    // complete if we have all collected pages of subframe 5
+    return m_almanac.isComplete();
 }
 
+/**
+ * @brief SubframeBufferD2::flushEphemerisData Get Ephemeris data and clear the
+ * buffer.
+ *
+ * The pages are lent, not copied. They stay valid until the next addSubframe().
+ *
+ * @return Ephemeris data as SubframeBufferParam.
+ */
 SubframeBufferParam SubframeBufferD2::flushEphemerisData()
 {
+    assert(isEphemerisComplete());
+
     // D2: all ephemeris data is inside subframe 1
-    const SubframeVectorVector ephdata { m_buffer[0] };
+    const std::size_t pagecount { m_ephemerispages == EphemerisPages::KLOBUCHAR
+                                  ? D2_KLOBUCHAR_PAGES : D2_FRAME_SIZE[0] };
+    const SubframeBufferParam ephdata(SubframeBufferType::D2_EPHEMERIS,
+                                      { m_ephemeris.lend(0, pagecount) });
 
     // ensure correct data sets, should not be possible!
-    assert(m_buffer[0].front().getPageNum() == 1);
-    assert(m_buffer[0].back().getPageNum() == D2_FRAME_SIZE[0]);
+    assert(ephdata.data[0].front().getPageNum() == 1);
+    assert(ephdata.data[0].back().getPageNum() == pagecount);
 
-    clearEphemerisData();
-
-    return SubframeBufferParam(SubframeBufferType::D2_EPHEMERIS, ephdata);
+    return ephdata;
 }
 
+/**
+ * @brief SubframeBufferD2::flushAlmanacData Get Almanac data and clear the
+ * buffer.
+ *
+ * The pages are lent, not copied. They stay valid until the next addSubframe().
+ * If only the ionospheric pages are collected, both IGP blocks are returned
+ * as separate frames.
+ *
+ * @return Almanac data as SubframeBufferParam.
+ */
 SubframeBufferParam SubframeBufferD2::flushAlmanacData()
 {
-    const SubframeVectorVector almdata { m_buffer[4] };
+    assert(isAlmanacComplete());
 
-    // ensure correct data sets, should not be possible!
-    assert(m_buffer[4].front().getPageNum() == 1);
-    assert(m_buffer[4].back().getPageNum() == D2_FRAME_SIZE[4]);
+    if (m_almanacpages == D2AlmanacPages::IONOSPHERE)
+    {
+        const SubframeBufferParam iondata(SubframeBufferType::D2_IONOSPHERE,
+                                          { m_almanac.lend(0, D2_IONOSPHERE_BLOCK_SIZE),
+                                            m_almanac.lend(D2_IONOSPHERE_BLOCK_SIZE, D2_IONOSPHERE_BLOCK_SIZE) });
 
-    clearAlmanacData();
+        // ensure correct data sets, should not be possible!
+        assert(iondata.data[0].front().getPageNum() == D2_IONOSPHERE_BLOCK_FIRSTPAGE[0]);
+        assert(iondata.data[1].front().getPageNum() == D2_IONOSPHERE_BLOCK_FIRSTPAGE[1]);
+
+        return iondata;
+    }
+
+    const SubframeBufferParam almdata(SubframeBufferType::D2_ALMANAC,
+                                      { m_almanac.lend(0, D2_FRAME_SIZE[4]) });
+
+    // ensure correct data sets, should not be possible!
+    assert(almdata.data[0].front().getPageNum() == 1);
+    assert(almdata.data[0].back().getPageNum() == D2_FRAME_SIZE[4]);
 
-    return SubframeBufferParam(SubframeBufferType::D2_ALMANAC, almdata);
+    return almdata;
 }
 
 void SubframeBufferD2::clearEphemerisData()
 {
-    m_buffer[0].clear();
+    m_ephemeris.clear();
 }
 
 void SubframeBufferD2::clearAlmanacData()
 {
-    m_buffer[4].clear();
+    m_almanac.clear();
 }
 
 } // namespace bnav
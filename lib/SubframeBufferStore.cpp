@@ -8,21 +8,15 @@ namespace bnav
  * object.
  *
  * Used to manage multiple SubframeBuffer objects for multiple SVs.
- */
-SubframeBufferStore::SubframeBufferStore()
-    : m_store()
-{
-}
-
-/**
- * @brief SubframeBufferStore::~SubframeBufferStore
  *
- * Clean up underlying SubframeBuffers if store gets destroyed.
+ * @param d2pages Pages of frame 5 the buffers of GEOs collect.
+ * @param ephpages Pages of the ephemeris data set all buffers collect.
  */
-SubframeBufferStore::~SubframeBufferStore()
+SubframeBufferStore::SubframeBufferStore(const D2AlmanacPages d2pages, const EphemerisPages ephpages)
+    : m_store()
+    , m_d2almanacpages(d2pages)
+    , m_ephemerispages(ephpages)
 {
-    for (auto elem : m_store)
-        delete elem.second;
 }
 
 /**
@@ -34,14 +28,12 @@ SubframeBufferStore::~SubframeBufferStore()
  */
 void SubframeBufferStore::addSvID(const SvID &sv)
 {
-    SubframeBuffer* sfbuf;
+    std::unique_ptr<SubframeBuffer> &sfbuf = m_store.insert(sv);
 
     if (sv.isGeo())
-        sfbuf = new SubframeBufferD2();
+        sfbuf.reset(new SubframeBufferD2(m_d2almanacpages, m_ephemerispages));
     else
-        sfbuf = new SubframeBufferD1();
-
-    m_store.emplace(sv, sfbuf);
+        sfbuf.reset(new SubframeBufferD1(m_ephemerispages));
 }
 
 /**
@@ -54,17 +46,11 @@ void SubframeBufferStore::addSvID(const SvID &sv)
  */
 void SubframeBufferStore::addSubframe(const SvID &sv, const Subframe &sf)
 {
-    auto it = m_store.find(sv);
-
     // initialize SV, if not present in store
-    if (it == m_store.end())
+    if (!m_store.contains(sv))
         addSvID(sv);
 
-    it = m_store.find(sv);
-    // ensure it got added
-    assert(it != m_store.end());
-
-    it->second->addSubframe(sf);
+    m_store.get(sv)->addSubframe(sf);
 }
 
 /**
@@ -74,15 +60,55 @@ void SubframeBufferStore::addSubframe(const SvID &sv, const Subframe &sf)
  */
 SubframeBuffer* SubframeBufferStore::getSubframeBuffer(const SvID &sv)
 {
-    auto it = m_store.find(sv);
-
-    if (it != m_store.end())
-        return it->second;
+    if (m_store.contains(sv))
+        return m_store.get(sv).get();
 
     assert(false); // who called this before adding the data?!
     return nullptr;
 }
 
+/**
+ * @brief SubframeBufferStore::getSubframeBufferD1 Get the SubframeBuffer of
+ * a non-GEO SV with its concrete type.
+ *
+ * Calls on the returned buffer are resolved at compile time. Adds the buffer,
+ * if the SV is not known yet.
+ *
+ * @param sv The SvID, has to be a non-GEO.
+ * @return SubframeBufferD1 for SV.
+ */
+SubframeBufferD1& SubframeBufferStore::getSubframeBufferD1(const SvID &sv)
+{
+    assert(!sv.isGeo());
+
+    if (!m_store.contains(sv))
+        addSvID(sv);
+
+    // type is fixed by SvID, see addSvID()
+    return static_cast<SubframeBufferD1&>(*m_store.get(sv));
+}
+
+/**
+ * @brief SubframeBufferStore::getSubframeBufferD2 Get the SubframeBuffer of
+ * a GEO with its concrete type.
+ *
+ * Calls on the returned buffer are resolved at compile time. Adds the buffer,
+ * if the SV is not known yet.
+ *
+ * @param sv The SvID, has to be a GEO.
+ * @return SubframeBufferD2 for SV.
+ */
+SubframeBufferD2& SubframeBufferStore::getSubframeBufferD2(const SvID &sv)
+{
+    assert(sv.isGeo());
+
+    if (!m_store.contains(sv))
+        addSvID(sv);
+
+    // type is fixed by SvID, see addSvID()
+    return static_cast<SubframeBufferD2&>(*m_store.get(sv));
+}
+
 /**
  * @brief SubframeBufferStore::hasIncompleteData Checks if any SubframeBuffer
  * of a SV has an incomplete data set.
@@ -91,9 +117,9 @@ SubframeBuffer* SubframeBufferStore::getSubframeBuffer(const SvID &sv)
  */
 bool SubframeBufferStore::hasIncompleteData() const
 {
-    for (const auto elem : m_store)
+    for (const SvID &sv : m_store.getSvList())
     {
-        if (elem.second->hasIncompleteData())
+        if (m_store.get(sv)->hasIncompleteData())
             return true;
     }
 
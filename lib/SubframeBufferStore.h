@@ -3,24 +3,29 @@
 
 #include "Subframe.h"
 #include "SubframeBuffer.h"
+#include "SvArray.h"
 #include "SvID.h"
 
-#include <map>
+#include <memory>
 
 namespace bnav
 {
 
 class SubframeBufferStore
 {
-    std::map<SvID, SubframeBuffer*> m_store;
+    SvArray< std::unique_ptr<SubframeBuffer> > m_store;
+    D2AlmanacPages m_d2almanacpages;
+    EphemerisPages m_ephemerispages;
 
 public:
-    SubframeBufferStore();
-    ~SubframeBufferStore();
+    SubframeBufferStore(const D2AlmanacPages d2pages = D2AlmanacPages::ALL,
+                        const EphemerisPages ephpages = EphemerisPages::ALL);
 
     void addSubframe(const SvID &sv, const Subframe &sf);
 
     SubframeBuffer* getSubframeBuffer(const SvID &sv);
+    SubframeBufferD1& getSubframeBufferD1(const SvID &sv);
+    SubframeBufferD2& getSubframeBufferD2(const SvID &sv);
 
     bool hasIncompleteData() const;
 
@@ -0,0 +1,233 @@
+#include "SubframeFusion.h"
+
+#include "BeiDou.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace bnav
+{
+
+SubframeFusion::MessageKey::MessageKey()
+    : sow(0)
+    , fraid(0)
+    , pnum(0)
+{
+}
+
+SubframeFusion::MessageKey::MessageKey(const Subframe &sf)
+    : sow(sf.getSOW())
+    , fraid(sf.getFrameID())
+    , pnum(sf.getPageNum())
+{
+}
+
+bool SubframeFusion::MessageKey::operator<(const MessageKey &rhs) const
+{
+    if (sow != rhs.sow)
+        return sow < rhs.sow;
+    if (fraid != rhs.fraid)
+        return fraid < rhs.fraid;
+    return pnum < rhs.pnum;
+}
+
+SubframeFusion::FusionState::FusionState()
+    : window()
+    , forwarded()
+    , newestSOW(0)
+    , restartSOW(0)
+    , hasForwarded(false)
+    , hasNewest(false)
+    , hasRestart(false)
+{
+}
+
+/**
+ * @brief SubframeFusion::SubframeFusion
+ * @param window Reorder window in seconds of SOW.
+ */
+SubframeFusion::SubframeFusion(const uint32_t window)
+    : m_state()
+    , m_window(window)
+    , m_duplicateCount(0)
+    , m_conflictCount(0)
+    , m_lateCount(0)
+{
+}
+
+/**
+ * @brief SubframeFusion::add Add a merged subframe of any receiver.
+ *
+ * A copy with the same hash is dropped. A copy with another hash has
+ * different bits in spite of parity, the one with less corrections is kept.
+ *
+ * @param sv The SvID.
+ * @param sf Merged subframe.
+ * @param ready Subframes which left the reorder window get appended, sorted.
+ */
+void SubframeFusion::add(const SvID &sv, const Subframe &sf, std::vector<Subframe> &ready)
+{
+    FusionState &state = m_state.insert(sv);
+    const MessageKey key(sf);
+
+    if (state.hasNewest)
+    {
+        if (key.sow + SECONDS_OF_A_WEEK / 2 < state.newestSOW)
+        {
+            // a single corrupt SOW must not flush the window
+            if (!isRollover(state, key.sow))
+            {
+                ++m_lateCount;
+                return;
+            }
+
+            // SOW started over, next week
+            forwardAll(state, ready);
+            state.hasForwarded = false;
+            state.hasNewest = false;
+        }
+        else if (key.sow > state.newestSOW + SECONDS_OF_A_WEEK / 2)
+        {
+            // belongs to the previous week
+            ++m_lateCount;
+            return;
+        }
+    }
+
+    // the window has moved on already
+    if (state.hasForwarded && !(state.forwarded < key))
+    {
+        ++m_lateCount;
+        return;
+    }
+
+    const std::size_t hash { sf.getHash() };
+    auto it = std::lower_bound(state.window.begin(), state.window.end(), key,
+                               [](const Entry &entry, const MessageKey &rhs) { return entry.key < rhs; });
+    if (it != state.window.end() && !(key < it->key))
+    {
+        if (it->hash == hash)
+        {
+            ++m_duplicateCount;
+        }
+        else
+        {
+            ++m_conflictCount;
+            if (sf.getParityModifiedCount() < it->sf.getParityModifiedCount())
+            {
+                it->hash = hash;
+                it->sf = sf;
+            }
+        }
+        return;
+    }
+
+    state.window.insert(it, Entry { key, hash, sf });
+
+    if (!state.hasNewest || state.newestSOW < key.sow)
+    {
+        state.newestSOW = key.sow;
+        state.hasNewest = true;
+        state.hasRestart = false;
+    }
+
+    if (state.newestSOW >= m_window)
+        forward(state, state.newestSOW - m_window, ready);
+}
+
+/**
+ * @brief SubframeFusion::flush Forward all subframes of the window, e.g. at EOF.
+ * @param sv The SvID.
+ * @param ready Subframes get appended, sorted.
+ */
+void SubframeFusion::flush(const SvID &sv, std::vector<Subframe> &ready)
+{
+    if (!m_state.contains(sv))
+        return;
+
+    forwardAll(m_state.get(sv), ready);
+}
+
+/**
+ * @brief SubframeFusion::forward Forward all subframes older than a SOW.
+ * @param state State of the SV.
+ * @param until First SOW, which is kept.
+ * @param ready Subframes get appended, sorted.
+ */
+void SubframeFusion::forward(FusionState &state, const uint32_t until, std::vector<Subframe> &ready)
+{
+    auto it = state.window.begin();
+    for (; it != state.window.end() && it->key.sow < until; ++it)
+    {
+        ready.push_back(it->sf);
+        state.forwarded = it->key;
+        state.hasForwarded = true;
+    }
+    state.window.erase(state.window.begin(), it);
+}
+
+void SubframeFusion::forwardAll(FusionState &state, std::vector<Subframe> &ready)
+{
+    for (const Entry &entry : state.window)
+    {
+        ready.push_back(entry.sf);
+        state.forwarded = entry.key;
+        state.hasForwarded = true;
+    }
+    state.window.clear();
+}
+
+/**
+ * @brief SubframeFusion::isRollover Check if a SOW far before the newest one
+ * starts the next week.
+ *
+ * This is the case, if the gap across the week change fits into the reorder
+ * window. After an outage at the week change, the second subframe within the
+ * window after the first one confirms the new week.
+ *
+ * @param state State of the SV, remembers an unconfirmed week start.
+ * @param sow SOW more than half a week before the newest one.
+ * @return true, if the next week started.
+ */
+bool SubframeFusion::isRollover(FusionState &state, const uint32_t sow) const
+{
+    if (state.newestSOW + m_window >= SECONDS_OF_A_WEEK
+            && sow + SECONDS_OF_A_WEEK <= state.newestSOW + m_window)
+        return true;
+
+    if (state.hasRestart && sow >= state.restartSOW && sow - state.restartSOW <= m_window)
+        return true;
+
+    state.restartSOW = sow;
+    state.hasRestart = true;
+    return false;
+}
+
+std::vector<SvID> SubframeFusion::getSvList() const
+{
+    return m_state.getSvList();
+}
+
+std::size_t SubframeFusion::getDuplicateCount() const
+{
+    return m_duplicateCount;
+}
+
+std::size_t SubframeFusion::getConflictCount() const
+{
+    return m_conflictCount;
+}
+
+std::size_t SubframeFusion::getLateCount() const
+{
+    return m_lateCount;
+}
+
+void SubframeFusion::dump() const
+{
+    std::cout << "Subframe fusion: " << m_duplicateCount << " duplicates, "
+              << m_conflictCount << " conflicts, "
+              << m_lateCount << " late" << std::endl;
+}
+
+} // namespace bnav
@@ -0,0 +1,90 @@
+#ifndef SUBFRAMEFUSION_H
+#define SUBFRAMEFUSION_H
+
+#include "Subframe.h"
+#include "SvArray.h"
+#include "SvID.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The SubframeFusion class
+ *
+ * Fuses the merged subframes of several receivers into one stream per SV.
+ * Copies are identified by PRN, SOW, FraID, Pnum and the hash of the
+ * corrected bits.
+ *
+ * Subframes are held in a reorder window of some seconds of SOW and are
+ * forwarded sorted, so a receiver may fill the pages another one missed as
+ * long as it is not later than the window. Subframes older than the last
+ * forwarded one are dropped, as well as single subframes with an implausible
+ * SOW jump back.
+ */
+class SubframeFusion
+{
+    /// order of messages, SOW first
+    struct MessageKey
+    {
+        uint32_t sow;
+        uint32_t fraid;
+        uint32_t pnum;
+
+        MessageKey();
+        MessageKey(const Subframe &sf);
+
+        bool operator<(const MessageKey &rhs) const;
+    };
+
+    struct Entry
+    {
+        MessageKey key;
+        std::size_t hash;
+        Subframe sf;
+    };
+
+    struct FusionState
+    {
+        std::vector<Entry> window; ///< sorted by MessageKey
+        MessageKey forwarded; ///< last forwarded message
+        uint32_t newestSOW;
+        uint32_t restartSOW; ///< unconfirmed start of a new week
+        bool hasForwarded;
+        bool hasNewest;
+        bool hasRestart;
+
+        FusionState();
+    };
+
+    SvArray<FusionState> m_state;
+    uint32_t m_window;
+    std::size_t m_duplicateCount;
+    std::size_t m_conflictCount;
+    std::size_t m_lateCount;
+
+public:
+    SubframeFusion(const uint32_t window = 6);
+
+    void add(const SvID &sv, const Subframe &sf, std::vector<Subframe> &ready);
+    void flush(const SvID &sv, std::vector<Subframe> &ready);
+
+    std::vector<SvID> getSvList() const;
+
+    std::size_t getDuplicateCount() const;
+    std::size_t getConflictCount() const;
+    std::size_t getLateCount() const;
+
+    void dump() const;
+
+private:
+    void forward(FusionState &state, const uint32_t until, std::vector<Subframe> &ready);
+    void forwardAll(FusionState &state, std::vector<Subframe> &ready);
+    bool isRollover(FusionState &state, const uint32_t sow) const;
+};
+
+} // namespace bnav
+
+#endif // SUBFRAMEFUSION_H
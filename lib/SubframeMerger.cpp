@@ -0,0 +1,121 @@
+#include "SubframeMerger.h"
+
+#include <iostream>
+
+namespace bnav
+{
+
+SubframeMerger::MergeState::MergeState()
+    : pending()
+    , last()
+    , hasPending(false)
+    , hasLast(false)
+{
+}
+
+SubframeMerger::SubframeMerger()
+    : m_state()
+    , m_duplicateCount(0)
+    , m_repairedWordCount(0)
+{
+}
+
+/**
+ * @brief SubframeMerger::add Add a fully initialized Subframe.
+ *
+ * @param sv The SvID.
+ * @param sf Subframe of any signal.
+ * @param ready Merged subframes which are ready for processing get appended,
+ * at most two (a held back one and sf).
+ */
+void SubframeMerger::add(const SvID &sv, const Subframe &sf, std::vector<Subframe> &ready)
+{
+    MergeState &state = m_state.insert(sv);
+
+    // copy of a subframe which was already forwarded
+    if (state.hasLast && state.last.isSameMessage(sf))
+    {
+        ++m_duplicateCount;
+        return;
+    }
+
+    if (state.hasPending)
+    {
+        if (state.pending.isSameMessage(sf))
+        {
+            ++m_duplicateCount;
+
+            // take every word the other copy received with less corrections
+            for (std::size_t word = 0; word < SUBFRAME_WORDS; ++word)
+            {
+                if (sf.getWordModifiedCount(word) < state.pending.getWordModifiedCount(word))
+                {
+                    state.pending.replaceWord(word, sf);
+                    ++m_repairedWordCount;
+                }
+            }
+
+            forward(state, state.pending, ready);
+            return;
+        }
+
+        // there is no other copy, keep the corrected one
+        forward(state, state.pending, ready);
+    }
+
+    if (sf.getParityModifiedCount() == 0)
+    {
+        forward(state, sf, ready);
+    }
+    else
+    {
+        state.pending = sf;
+        state.hasPending = true;
+    }
+}
+
+/**
+ * @brief SubframeMerger::flush Forward a held back subframe, e.g. at EOF.
+ * @param sv The SvID.
+ * @param ready The subframe gets appended, if there is one.
+ */
+void SubframeMerger::flush(const SvID &sv, std::vector<Subframe> &ready)
+{
+    if (!m_state.contains(sv))
+        return;
+
+    MergeState &state = m_state.get(sv);
+    if (state.hasPending)
+        forward(state, state.pending, ready);
+}
+
+void SubframeMerger::forward(MergeState &state, const Subframe &sf, std::vector<Subframe> &ready)
+{
+    ready.push_back(sf);
+    state.last = sf;
+    state.hasLast = true;
+    state.hasPending = false;
+}
+
+std::vector<SvID> SubframeMerger::getSvList() const
+{
+    return m_state.getSvList();
+}
+
+std::size_t SubframeMerger::getDuplicateCount() const
+{
+    return m_duplicateCount;
+}
+
+std::size_t SubframeMerger::getRepairedWordCount() const
+{
+    return m_repairedWordCount;
+}
+
+void SubframeMerger::dump() const
+{
+    std::cout << "Subframe merge: " << m_duplicateCount << " duplicates, "
+              << m_repairedWordCount << " repaired words" << std::endl;
+}
+
+} // namespace bnav
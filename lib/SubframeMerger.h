@@ -0,0 +1,59 @@
+#ifndef SUBFRAMEMERGER_H
+#define SUBFRAMEMERGER_H
+
+#include "Subframe.h"
+#include "SvArray.h"
+#include "SvID.h"
+
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The SubframeMerger class
+ *
+ * Merges the copies of one subframe received on several signals (B1 and B2)
+ * into one subframe. Copies are identified by PRN, SOW, FraID and Pnum.
+ *
+ * A copy without parity corrections is forwarded at once, later copies are
+ * dropped. A copy with corrections is held back until its twin arrives, which
+ * repairs every word the twin received with less corrections, or until the
+ * next subframe of the SV arrives.
+ */
+class SubframeMerger
+{
+    struct MergeState
+    {
+        Subframe pending; ///< copy with parity corrections, waiting for its twin
+        Subframe last; ///< last forwarded subframe
+        bool hasPending;
+        bool hasLast;
+
+        MergeState();
+    };
+
+    SvArray<MergeState> m_state;
+    std::size_t m_duplicateCount;
+    std::size_t m_repairedWordCount;
+
+public:
+    SubframeMerger();
+
+    void add(const SvID &sv, const Subframe &sf, std::vector<Subframe> &ready);
+    void flush(const SvID &sv, std::vector<Subframe> &ready);
+
+    std::vector<SvID> getSvList() const;
+
+    std::size_t getDuplicateCount() const;
+    std::size_t getRepairedWordCount() const;
+
+    void dump() const;
+
+private:
+    void forward(MergeState &state, const Subframe &sf, std::vector<Subframe> &ready);
+};
+
+} // namespace bnav
+
+#endif // SUBFRAMEMERGER_H
@@ -0,0 +1,96 @@
+#ifndef SVARRAY_H
+#define SVARRAY_H
+
+#include "BeiDou.h"
+#include "SvID.h"
+
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The SvArray class
+ *
+ * Dense storage with one preallocated item per PRN. An occupancy mask keeps
+ * track of the SVs which were inserted. Lookups are a plain array index,
+ * iteration over getSvList() is sorted by PRN.
+ */
+template <typename T>
+class SvArray
+{
+    std::array<T, BDS_MAX_PRN> m_items;
+    std::bitset<BDS_MAX_PRN> m_occupied;
+
+public:
+    SvArray()
+        : m_items()
+        , m_occupied()
+    {
+    }
+
+    bool contains(const SvID &sv) const
+    {
+        return m_occupied.test(index(sv));
+    }
+
+    bool empty() const
+    {
+        return m_occupied.none();
+    }
+
+    std::size_t size() const
+    {
+        return m_occupied.count();
+    }
+
+    /// Mark SV as occupied and return its item, which is kept if present.
+    T& insert(const SvID &sv)
+    {
+        const std::size_t idx { index(sv) };
+        m_occupied.set(idx);
+        return m_items[idx];
+    }
+
+    T& get(const SvID &sv)
+    {
+        assert(contains(sv));
+        return m_items[index(sv)];
+    }
+
+    const T& get(const SvID &sv) const
+    {
+        assert(contains(sv));
+        return m_items[index(sv)];
+    }
+
+    /// SvIDs of all occupied items, sorted by PRN.
+    std::vector<SvID> getSvList() const
+    {
+        std::vector<SvID> svlist;
+        svlist.reserve(m_occupied.count());
+
+        for (std::size_t i = 0; i < BDS_MAX_PRN; ++i)
+        {
+            if (m_occupied.test(i))
+                svlist.push_back(SvID(static_cast<uint32_t>(i + 1)));
+        }
+
+        return svlist;
+    }
+
+private:
+    static std::size_t index(const SvID &sv)
+    {
+        // PRN 0 is the uninitialized SvID
+        assert(sv.getPRN() > 0 && sv.getPRN() <= BDS_MAX_PRN);
+        return sv.getPRN() - 1;
+    }
+};
+
+} // namespace bnav
+
+#endif // SVARRAY_H
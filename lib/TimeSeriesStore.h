@@ -0,0 +1,264 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include "BeiDou.h"
+#include "DateTime.h"
+#include "SvArray.h"
+#include "SvID.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bnav
+{
+
+/**
+ * @brief The TimeSeries class
+ *
+ * Items sorted by epoch in contiguous arrays. An epoch is the BDT week and
+ * SOW packed into seconds since the BDT origin. Appending in time order is
+ * amortized O(1), an older epoch is inserted in place. Lookups are a binary
+ * search, which return the index of an item or size(), if there is none.
+ *
+ * Evicted items are only skipped at first. They are removed from the arrays,
+ * when there are as many of them as items left, so evicting the oldest items
+ * is amortized O(1) as well.
+ */
+template <typename T>
+class TimeSeries
+{
+    std::vector<std::uint64_t> m_epochs;
+    std::vector<T> m_items;
+    std::size_t m_first; ///< index of the first item, the ones before are evicted
+
+public:
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    TimeSeries()
+        : m_epochs()
+        , m_items()
+        , m_first(0)
+    {
+    }
+
+    static std::uint64_t toEpoch(const DateTime &datetime)
+    {
+        return static_cast<std::uint64_t>(datetime.getWeekNum()) * SECONDS_OF_A_WEEK + datetime.getSOW();
+    }
+
+    static DateTime toDateTime(const std::uint64_t epoch)
+    {
+        return DateTime(TimeSystem::BDT, static_cast<uint32_t>(epoch / SECONDS_OF_A_WEEK),
+                        static_cast<uint32_t>(epoch % SECONDS_OF_A_WEEK));
+    }
+
+    std::size_t size() const { return m_items.size() - m_first; }
+    bool empty() const { return size() == 0; }
+
+    /// Remove all items, keep the storage
+    void clear()
+    {
+        m_epochs.clear();
+        m_items.clear();
+        m_first = 0;
+    }
+
+    void reserve(const std::size_t size)
+    {
+        m_epochs.reserve(m_first + size);
+        m_items.reserve(m_first + size);
+    }
+
+    /// Insert an item, the item of the same epoch is replaced.
+    T& insert(const DateTime &datetime, T item)
+    {
+        const std::uint64_t epoch { toEpoch(datetime) };
+        if (empty() || m_epochs.back() < epoch)
+        {
+            m_epochs.push_back(epoch);
+            m_items.push_back(std::move(item));
+            return m_items.back();
+        }
+
+        const auto it = std::lower_bound(beginEpochs(), m_epochs.end(), epoch);
+        const std::size_t index = static_cast<std::size_t>(it - m_epochs.begin());
+        if (*it != epoch)
+        {
+            m_epochs.insert(it, epoch);
+            m_items.insert(m_items.begin() + static_cast<std::ptrdiff_t>(index), std::move(item));
+        }
+        else
+        {
+            m_items[index] = std::move(item);
+        }
+        return m_items[index];
+    }
+
+    /// Index of the item of an epoch, size() if there is none.
+    std::size_t find(const DateTime &datetime) const
+    {
+        const std::uint64_t epoch { toEpoch(datetime) };
+        const auto it = std::lower_bound(beginEpochs(), m_epochs.end(), epoch);
+        if (it == m_epochs.end() || *it != epoch)
+            return size();
+
+        return static_cast<std::size_t>(it - beginEpochs());
+    }
+
+    /// Index of the latest item at or before an epoch, size() if there is none.
+    std::size_t findLatest(const DateTime &datetime) const
+    {
+        const auto it = std::upper_bound(beginEpochs(), m_epochs.end(), toEpoch(datetime));
+        if (it == beginEpochs())
+            return size();
+
+        return static_cast<std::size_t>(it - beginEpochs()) - 1;
+    }
+
+    /// Items from an epoch until an epoch, both included.
+    std::pair<const_iterator, const_iterator> getRange(const DateTime &from, const DateTime &until) const
+    {
+        const auto first = std::lower_bound(beginEpochs(), m_epochs.end(), toEpoch(from));
+        const auto last = std::upper_bound(first, m_epochs.end(), toEpoch(until));
+        return std::make_pair(m_items.begin() + (first - m_epochs.begin()),
+                              m_items.begin() + (last - m_epochs.begin()));
+    }
+
+    /// Count of the items before an epoch.
+    std::size_t countBefore(const std::uint64_t epoch) const
+    {
+        return static_cast<std::size_t>(std::lower_bound(beginEpochs(), m_epochs.end(), epoch) - beginEpochs());
+    }
+
+    /// Remove the oldest items, each is handed to the sink before, which may
+    /// take it. The storage is kept.
+    template <typename Sink>
+    void evict(const std::size_t count, Sink sink)
+    {
+        assert(count <= size());
+        for (std::size_t i = 0; i < count; ++i)
+            sink(m_items[m_first + i]);
+
+        m_first += count;
+        if (m_first < size())
+            return;
+
+        m_epochs.erase(m_epochs.begin(), beginEpochs());
+        m_items.erase(m_items.begin(), begin());
+        m_first = 0;
+    }
+
+    /// Item of an epoch, which has to exist.
+    const T& at(const DateTime &datetime) const
+    {
+        const std::size_t index { find(datetime) };
+        assert(index < size());
+        return (*this)[index];
+    }
+
+    std::uint64_t getEpoch(const std::size_t index) const
+    {
+        assert(index < size());
+        return m_epochs[m_first + index];
+    }
+
+    DateTime getDateTime(const std::size_t index) const
+    {
+        return toDateTime(getEpoch(index));
+    }
+
+    T& operator[](const std::size_t index)
+    {
+        assert(index < size());
+        return m_items[m_first + index];
+    }
+
+    const T& operator[](const std::size_t index) const
+    {
+        assert(index < size());
+        return m_items[m_first + index];
+    }
+
+    const T& front() const { return (*this)[0]; }
+    const T& back() const { return m_items.back(); }
+
+    iterator begin() { return m_items.begin() + static_cast<std::ptrdiff_t>(m_first); }
+    iterator end() { return m_items.end(); }
+    const_iterator begin() const { return m_items.begin() + static_cast<std::ptrdiff_t>(m_first); }
+    const_iterator end() const { return m_items.end(); }
+
+private:
+    std::vector<std::uint64_t>::iterator beginEpochs()
+    {
+        return m_epochs.begin() + static_cast<std::ptrdiff_t>(m_first);
+    }
+
+    std::vector<std::uint64_t>::const_iterator beginEpochs() const
+    {
+        return m_epochs.begin() + static_cast<std::ptrdiff_t>(m_first);
+    }
+};
+
+/**
+ * @brief The TimeSeriesStore class
+ *
+ * One TimeSeries per SV, e.g. of Ionosphere models, KlobucharParam or
+ * Ephemeris.
+ */
+template <typename T>
+class TimeSeriesStore
+{
+    SvArray< TimeSeries<T> > m_store;
+
+public:
+    TimeSeriesStore()
+        : m_store()
+    {
+    }
+
+    /// Insert an item of a SV, the item of the same epoch is replaced.
+    T& insert(const SvID &sv, const DateTime &datetime, T item)
+    {
+        return m_store.insert(sv).insert(datetime, std::move(item));
+    }
+
+    bool contains(const SvID &sv) const
+    {
+        return m_store.contains(sv);
+    }
+
+    bool hasDataForSv(const SvID &sv) const
+    {
+        return m_store.contains(sv) && !m_store.get(sv).empty();
+    }
+
+    bool empty() const
+    {
+        return m_store.empty();
+    }
+
+    TimeSeries<T>& get(const SvID &sv)
+    {
+        return m_store.get(sv);
+    }
+
+    const TimeSeries<T>& get(const SvID &sv) const
+    {
+        return m_store.get(sv);
+    }
+
+    /// SvIDs of all SVs, which were inserted, sorted by PRN.
+    std::vector<SvID> getSvList() const
+    {
+        return m_store.getSvList();
+    }
+};
+
+} // namespace bnav
+
+#endif // TIMESERIESSTORE_H
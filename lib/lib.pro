@@ -5,6 +5,8 @@
 TEMPLATE = lib
 TARGET = bnav
 
+CONFIG += thread
+
 LIBS += -lboost_date_time
 
 SOURCES += \
@@ -23,7 +25,19 @@ SOURCES += \
     DateTime.cpp \
     IonexWriter.cpp \
     MessageStatistic.cpp \
-    IonosphereGridInfo.cpp
+    IonosphereGridInfo.cpp \
+    PageFilter.cpp \
+    SubframeMerger.cpp \
+    IonospherePool.cpp \
+    SubframeFusion.cpp \
+    PageVoter.cpp \
+    IonosphereConsensus.cpp \
+    KlobucharEvaluator.cpp \
+    KlobucharMapGenerator.cpp \
+    IonosphereInterpolator.cpp \
+    SlantDelayEvaluator.cpp \
+    IonosphereGrid.cpp \
+    IonosphereSnapshot.cpp
 
 HEADERS += \
     AsciiReader.h \
@@ -44,5 +58,19 @@ HEADERS += \
     IonexWriter.h \
     MessageStatistic.h \
     IonosphereGridInfo.h \
-    Tools.h
+    Tools.h \
+    PageFilter.h \
+    SvArray.h \
+    SubframeMerger.h \
+    IonospherePool.h \
+    SubframeFusion.h \
+    PageVoter.h \
+    IonosphereConsensus.h \
+    KlobucharEvaluator.h \
+    KlobucharMapGenerator.h \
+    IonosphereInterpolator.h \
+    SlantDelayEvaluator.h \
+    IonosphereGrid.h \
+    TimeSeriesStore.h \
+    IonosphereSnapshot.h
 
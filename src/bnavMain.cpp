@@ -3,6 +3,7 @@
 #include "BeiDou.h"
 #include "Ephemeris.h"
 #include "IonexWriter.h"
+#include "KlobucharMapGenerator.h"
 #include "Ionosphere.h"
 #include "Subframe.h"
 #include "SubframeBuffer.h"
@@ -10,9 +11,17 @@
 
 #include "DateTime.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdlib>
+#include <iomanip>
 #include <limits>
+#include <sstream>
+#include <thread>
+#include <utility>
 
+#include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/program_options.hpp>
 #include <boost/regex.hpp>
 
@@ -48,24 +57,113 @@ boost::optional<std::string> lcl_extractDateStringFromIGSFilename(const std::str
     return datestring;
 }
 
+/**
+ * @brief lcl_parseDate Parse a date string in format YYYYMMDD.
+ * @param datestr Date string.
+ * @return The date.
+ */
+boost::gregorian::date lcl_parseDate(const std::string &datestr)
+{
+    if (datestr.length() != 8 || datestr.find_first_not_of("0123456789") != std::string::npos)
+        throw std::invalid_argument("Invalid date: " + datestr);
+
+    try
+    {
+        return boost::gregorian::from_undelimited_string(datestr);
+    }
+    catch (const std::exception &)
+    {
+        // invalid month or day of month
+        throw std::invalid_argument("Invalid date: " + datestr);
+    }
+}
+
+/**
+ * @brief lcl_addFilenameSuffix Add a suffix to a filename, in front of its
+ * extension.
+ * @param filename Filename, e.g. "dir/regional.inx".
+ * @param suffix The suffix, e.g. "-prn02".
+ * @return Filename with suffix, e.g. "dir/regional-prn02.inx".
+ */
+std::string lcl_addFilenameSuffix(const std::string &filename, const std::string &suffix)
+{
+    const std::size_t lastdot = filename.find_last_of('.');
+    const std::size_t lastslash = filename.find_last_of('/');
+
+    // no extension, or the dot belongs to a dir part
+    if (lastdot == std::string::npos || (lastslash != std::string::npos && lastdot < lastslash))
+        return filename + suffix;
+
+    return filename.substr(0, lastdot) + suffix + filename.substr(lastdot);
+}
+
+/**
+ * @brief lcl_checkSpacing Check if a grid spacing fits into the Ionex format
+ * and into the extent of the grid.
+ * @param spacing Spacing in degrees.
+ * @param extent Extent of the grid in degrees.
+ * @param name Name of the option.
+ */
+void lcl_checkSpacing(const double spacing, const double extent, const std::string &name)
+{
+    // Ionex writes coordinates with one decimal
+    const double steps { extent / spacing };
+    if (!(spacing > 0.0) || std::fabs(spacing * 10.0 - std::round(spacing * 10.0)) > 1e-9
+            || std::fabs(steps - std::round(steps)) > 1e-9)
+        throw std::invalid_argument("Invalid grid spacing for --" + name + ": " + std::to_string(spacing));
+}
+
+/// lines read at once, they are decoded while the next batch is read
+constexpr std::size_t BATCH_LINES = 20000;
+
+/**
+ * @brief lcl_updateLatest Keep the latest of all given dates.
+ * @param latest Latest date so far, none for no date.
+ * @param dt New date.
+ */
+void lcl_updateLatest(boost::optional<bnav::DateTime> &latest, const bnav::DateTime &dt)
+{
+    if (!latest || *latest < dt)
+        latest = dt;
+}
+
+// decode the header with the parser of the buffer's message type
+void lcl_initializeHeader(bnav::Subframe &sf, const bnav::SubframeBufferD1 &)
+{
+    sf.initializeHeaderD1();
+}
+
+void lcl_initializeHeader(bnav::Subframe &sf, const bnav::SubframeBufferD2 &)
+{
+    sf.initializeHeaderD2();
+}
+
 }
 
 namespace bnav
 {
 
 bnavMain::bnavMain(int argc, char *argv[])
-    : filenameInput()
+    : filenamesInput()
     , filetypeInput(bnav::AsciiReaderType::NONE)
     , filenameIonexKlobuchar()
     , filenameIonexRegional()
     , generateGlobalKlobuchar(false)
     , limit_to_interval_regional(0)
     , limit_to_interval_klobuchar(0)
-    , limit_to_prn(boost::optional<SvID>())
-    , limit_to_date(boost::optional<DateTime>())
-    , sbstore()
-    , ionostore()
-    , ionostoreKlobuchar()
+    , klobuchar_latspacing(2.5)
+    , klobuchar_longspacing(5.0)
+    , limit_to_prn()
+    , limit_to_date_first()
+    , limit_to_date_last()
+    , threadcount(1)
+    , fusion_window(0)
+    , vote_depth(0)
+    , consensus(false)
+    , pagefilter()
+    , shards()
+    , daystores()
+    , lastClosedDay(boost::date_time::not_a_date_time)
 {
     std::string limit_to_date_str;
     boost::program_options::options_description desc("Generic options");
@@ -76,14 +174,20 @@ bnavMain::bnavMain(int argc, char *argv[])
             ("klobuchar,k", boost::program_options::value<std::string>(&filenameIonexKlobuchar), "save Klobuchar models to file")
             ("regional,r", boost::program_options::value<std::string>(&filenameIonexRegional), "save regional grid models to file")
             ("global", "generate global Klobuchar model")
-            ("sv,s", boost::program_options::value< std::vector<std::size_t> >(), "proceed only specified PRN")
+            ("sv,s", boost::program_options::value< std::vector<std::uint32_t> >(), "proceed only specified PRN, may be repeated (default: all)")
             ("ir", boost::program_options::value<std::uint32_t>(&limit_to_interval_regional)->default_value(7200), "decimate Regional Ionex output to interval [s]")
-            ("ik", boost::program_options::value<std::uint32_t>(&limit_to_interval_klobuchar)->default_value(7200), "decimate Klobuchar Ionex output to interval [s]")
-            ("date,d", boost::program_options::value<std::string>(&limit_to_date_str), "limit Ionex output to date")
-            ("file", boost::program_options::value<std::string>(&filenameInput)->required(), "input file name");
+            ("ik", boost::program_options::value<std::uint32_t>(&limit_to_interval_klobuchar)->default_value(7200), "decimate Klobuchar Ionex output to interval [s], below 7200s each model is evaluated at every epoch")
+            ("klat", boost::program_options::value<double>(&klobuchar_latspacing)->default_value(2.5), "latitude spacing of Klobuchar Ionex output [deg]")
+            ("klon", boost::program_options::value<double>(&klobuchar_longspacing)->default_value(5.0), "longitude spacing of Klobuchar Ionex output [deg]")
+            ("threads,j", boost::program_options::value<std::size_t>(&threadcount)->default_value(1), "decode with this number of threads, SVs are split among them")
+            ("date,d", boost::program_options::value<std::string>(&limit_to_date_str), "limit Ionex output to date (YYYYMMDD), range of dates (YYYYMMDD-YYYYMMDD) or all")
+            ("window", boost::program_options::value<std::uint32_t>(&fusion_window)->default_value(6), "reorder window [s] to fuse more than one input file")
+            ("vote", boost::program_options::value<std::size_t>(&vote_depth)->default_value(0), "repair corrected pages by majority vote with their last copies, count of copies (0: off)")
+            ("consensus", "fuse the models of all GEOs into one product, which fills the gaps of each GEO")
+            ("file", boost::program_options::value< std::vector<std::string> >(&filenamesInput)->required(), "input file names, one per station");
 
     boost::program_options::positional_options_description positionalopts;
-    positionalopts.add("file", 1);
+    positionalopts.add("file", -1);
 
     boost::program_options::variables_map vm;
     try
@@ -112,9 +216,18 @@ bnavMain::bnavMain(int argc, char *argv[])
         }
         if (vm.count("sv"))
         {
-            std::vector<std::uint32_t> svlist = vm["sv"].as< std::vector<std::uint32_t> >();
-            assert(svlist.size() == 1); // atm we can only choose one element
-            limit_to_prn = SvID(svlist[0]);
+            for (const std::uint32_t prn : vm["sv"].as< std::vector<std::uint32_t> >())
+            {
+                if (prn == 0 || prn > BDS_MAX_PRN)
+                    throw std::invalid_argument("Invalid PRN: " + std::to_string(prn));
+
+                limit_to_prn.set(prn - 1);
+            }
+        }
+        if (vm.count("consensus"))
+        {
+            // all GEOs broadcast the same Klobuchar model and regional grid
+            consensus = true;
         }
         if (vm.count("global"))
         {
@@ -137,32 +250,46 @@ bnavMain::bnavMain(int argc, char *argv[])
             if (limit_to_interval_klobuchar == 0)
                 throw std::invalid_argument("Cannot set interval to zero!");
 
-            // With an interval <7200s we would interpolate data. We only
-            // want new model data. If there is a need for <7200s data, the
-            // klob != klob_old condition has to be removed.
-            if (limit_to_interval_klobuchar < 7200)
-                throw std::invalid_argument("Interval <7200s is not possible for Klobuchar.");
+            // With an interval <7200s a model is evaluated at each epoch
+            // until the next model, the epochs have to meet the model.
+            if (limit_to_interval_klobuchar < KLOBUCHAR_UPDATE_INTERVAL
+                    && KLOBUCHAR_UPDATE_INTERVAL % limit_to_interval_klobuchar != 0)
+                throw std::invalid_argument("Interval <7200s has to be a divisor of 7200s for Klobuchar.");
 
             std::cout << "Setting interval to " << limit_to_interval_klobuchar << "s" << std::endl;
         }
+        if (vm.count("klat") || vm.count("klon"))
+        {
+            const IonoGridDimension dim { getKlobucharGridDimension(generateGlobalKlobuchar) };
+            lcl_checkSpacing(klobuchar_latspacing, dim.latitude_north - dim.latitude_south, "klat");
+            lcl_checkSpacing(klobuchar_longspacing, dim.longitude_east - dim.longitude_west, "klon");
+        }
+        if (vm.count("threads"))
+        {
+            if (threadcount == 0)
+                throw std::invalid_argument("Cannot set threads to zero!");
+
+            // each thread needs at least one SV
+            if (threadcount > BDS_MAX_PRN)
+                threadcount = BDS_MAX_PRN;
+        }
         if (vm.count("date"))
         {
             // limit data processing to a specific date, this is higher
             // in priority than extracting the date from filename.
+            if (limit_to_date_str != "all")
+            {
+                const std::size_t dash = limit_to_date_str.find('-');
+                limit_to_date_first = lcl_parseDate(limit_to_date_str.substr(0, dash));
+                limit_to_date_last = limit_to_date_first;
+                if (dash != std::string::npos)
+                    limit_to_date_last = lcl_parseDate(limit_to_date_str.substr(dash + 1));
 
-            // check for date validity
-            if (limit_to_date_str.length() != 8)
-                throw std::invalid_argument("Invalid date!");
-
-            //FIXME: maybe try to parse the date and catch exceptions
+                if (*limit_to_date_last < *limit_to_date_first)
+                    throw std::invalid_argument("Invalid date range: " + limit_to_date_str);
+            }
         }
     }
-    catch (const boost::program_options::too_many_positional_options_error &)
-    {
-        std::stringstream msg;
-        msg << "Error: Only one input file allowed." << std::endl << std::endl << desc;
-        throw std::runtime_error(msg.str());
-    }
     catch (const boost::program_options::error &e)
     {
         std::stringstream msg;
@@ -188,187 +315,760 @@ bnavMain::bnavMain(int argc, char *argv[])
         // extract date from filename, so we have a clue which data we want
         // to extract from the file (it's possible that there is more than
         // one day data inside the file.
-        boost::optional<std::string> igsdate = lcl_extractDateStringFromIGSFilename(filenameInput);
+        boost::optional<std::string> igsdate = lcl_extractDateStringFromIGSFilename(filenamesInput.front());
         if (igsdate)
         {
             limit_to_date_str = igsdate.get();
             std::cout << "Date limit from IGS filename: " << limit_to_date_str << std::endl;
+
+            // the regex matched eight digits, but it may be no valid date
+            try
+            {
+                limit_to_date_first = lcl_parseDate(limit_to_date_str);
+                limit_to_date_last = limit_to_date_first;
+            }
+            catch (const std::invalid_argument &e)
+            {
+                throw std::runtime_error(std::string("Error: ") + e.what());
+            }
         }
     }
 
-    if (!limit_to_prn)
-        throw std::runtime_error("Please limit to a specific SV!");
+    // without --sv proceed all SVs in one pass
+    if (limit_to_prn.none())
+        limit_to_prn.set();
 
     if (limit_to_date_str.empty())
-        throw std::runtime_error("Please limit to a specific day!");
+        throw std::runtime_error("Please limit to a specific day, a range of days or all!");
+
+    if (!limit_to_date_first)
+    {
+        std::cout << "Limiting date to: all days" << std::endl;
+    }
+    else if (isMultiDay())
+    {
+        std::cout << "Limiting date to: " << boost::gregorian::to_iso_string(*limit_to_date_first)
+                  << " - " << boost::gregorian::to_iso_string(*limit_to_date_last) << std::endl;
+    }
+    else
+    {
+        std::cout << "Limiting date to: " << boost::gregorian::to_iso_string(*limit_to_date_first) << std::endl;
 
-    limit_to_date = bnav::DateTime(bnav::TimeSystem::BDT, limit_to_date_str + "T000000");
-    std::cout << "Limiting date to: " << limit_to_date->getISODate() << std::endl;
+        // a single day is written even without data, to report its
+        // empty stores
+        daystores[*limit_to_date_first];
+    }
+
+    // decode only pages of requested products, without any output file
+    // generate both to get the store statistics
+    const bool noOutput { filenameIonexKlobuchar.empty() && filenameIonexRegional.empty() };
+    if (noOutput || !filenameIonexKlobuchar.empty())
+        pagefilter.enableProduct(bnav::Product::KLOBUCHAR);
+    if (noOutput || !filenameIonexRegional.empty())
+        pagefilter.enableProduct(bnav::Product::REGIONAL_GRID);
+
+    // no more shards than selected SVs, map generation still uses all
+    // threads
+    const std::size_t shardcount { std::min(threadcount, limit_to_prn.count()) };
+    for (std::size_t i = 0; i < shardcount; ++i)
+        shards.emplace_back(new Shard(filenamesInput.size(), fusion_window, vote_depth));
+
+    if (filenamesInput.size() > 1)
+        std::cout << "Fusing " << filenamesInput.size() << " stations with a window of " << fusion_window << "s" << std::endl;
 }
 
-void bnavMain::readInputFile()
+bnavMain::Shard::Shard(const std::size_t stationcount, const std::uint32_t window, const std::size_t votedepth)
+    : lines()
+    , svstate()
+    , msgstat()
+    , mergers(stationcount)
+    , mergedSubframes()
+    , fusion(window)
+    , fusedSubframes()
+    , voter(votedepth > 0 ? new bnav::PageVoter(votedepth) : nullptr)
+    // frame 5 is only used for the regional grid, ephemeris only for
+    // Klobuchar, skip all other pages
+    , sbstore(bnav::D2AlmanacPages::IONOSPHERE, bnav::EphemerisPages::KLOBUCHAR)
+    , regionalPool()
+    , klobucharPool()
+    , models()
+    , latestDataSet()
 {
-    // Open file and parse lines
-    bnav::AsciiReader reader(filenameInput, filetypeInput);
-    if (!reader.isOpen())
-        std::perror(("Error: Could not open file: " + filenameInput).c_str());
-
-    uint32_t weeknum {0};
-    uint32_t intervalCountOld = std::numeric_limits<uint32_t>::max();
-    bnav::Ionosphere iono_old;
-    bnav::KlobucharParam klob_old;
-    bnav::MessageStatistic msgstat;
+}
 
-    bnav::AsciiReaderEntry data;
-    while (reader.readLine(data))
+void bnavMain::readInputFile()
+{
+    // Open files and parse lines
+    std::vector<InputStream> streams;
+    for (const std::string &filename : filenamesInput)
     {
-        const bnav::SvID sv(data.getPRN());
+        InputStream stream { std::unique_ptr<bnav::AsciiReader>(new bnav::AsciiReader(filename, filetypeInput)), bnav::AsciiReaderEntry(), false };
+        if (!stream.reader->isOpen())
+            std::perror(("Error: Could not open file: " + filename).c_str());
 
-        if (limit_to_prn && sv != limit_to_prn.get())
-            continue;
+        stream.hasNext = stream.reader->readLine(stream.next);
+        streams.push_back(std::move(stream));
+    }
 
-        bnav::Subframe sf(sv, data.getBits());
+    std::vector< std::vector<InputLine> > batch(shards.size());
+    bool hasLines = readBatch(streams, batch);
+    while (hasLines)
+    {
+        for (std::size_t i = 0; i < shards.size(); ++i)
+            shards[i]->lines.swap(batch[i]);
 
-        // store only messages into stat, if we have a correct BeiDou date
-        if (weeknum != 0)
+        if (shards.size() == 1)
         {
-            const bnav::DateTime bdt = bnav::DateTime(bnav::TimeSystem::BDT, weeknum, sf.getSOW());
-            msgstat.add(sv, bdt);
+            processShard(*shards.front());
+            hasLines = readBatch(streams, batch);
         }
+        else
+        {
+            // one worker per shard, read the next batch meanwhile
+            std::vector<std::thread> workers;
+            for (const std::unique_ptr<Shard> &shard : shards)
+                workers.emplace_back(&bnavMain::processShard, this, std::ref(*shard));
 
-        sbstore.addSubframe(sv, sf);
+            hasLines = readBatch(streams, batch);
+
+            for (std::thread &worker : workers)
+                worker.join();
+        }
+
+        mergeShardModels();
+    }
+    for (InputStream &stream : streams)
+        stream.reader->close();
 
-        bnav::SubframeBuffer* sfbuf = sbstore.getSubframeBuffer(sv);
+    // process subframes which were held back for merging
+    for (const std::unique_ptr<Shard> &shard : shards)
+        flushShard(*shard);
+    mergeShardModels();
 
-        if (sfbuf->isEphemerisComplete())
+    std::size_t duplicateCount = 0;
+    std::size_t repairedWordCount = 0;
+    std::size_t fusionDuplicateCount = 0;
+    std::size_t fusionConflictCount = 0;
+    std::size_t fusionLateCount = 0;
+    std::size_t votedWordCount = 0;
+    std::size_t votedRepairedWordCount = 0;
+    bool hasIncompleteData = false;
+    bnav::MessageStatistic msgstat;
+    for (const std::unique_ptr<Shard> &shard : shards)
+    {
+        for (const bnav::SubframeMerger &merger : shard->mergers)
         {
-            const bnav::SubframeBufferParam bdata = sfbuf->flushEphemerisData();
-            //std::cout << "eph complete" << std::endl;
-
-            bnav::Ephemeris eph(bdata);
-            // store weeknum, because it's only present in Ephemeris data, we
-            // need this for Ionosphere, too.
-            weeknum = eph.getWeekNum();
-
-            // Model is updated at every full two hour (00:00, 02:00, 04:00,...).
-            // Try to get at least one model within this time frame. It may
-            // be the case, that there is no data until 01:50, but with this
-            // we can grep the model within the last 10 minutes of transmission.
-            uint32_t intervalCount = eph.getSOW() / limit_to_interval_klobuchar;
-            // FIXME: we take only PRN 2 data here, if we would like to
-            // replace missing data of prn 2 with other geos we have to
-            // think about IonosphereStore, which stores in depending on SvID!
-            if (limit_to_prn && sv == limit_to_prn.get() && intervalCount != intervalCountOld)
-            {
-                intervalCountOld = intervalCount;
-                bnav::KlobucharParam klob = eph.getKlobucharParam();
-
-                // Take only one new model.
-                if (klob != klob_old)
-                {
-                    std::cout << "New Klobuchar Model at SOW: " << eph.getSOW() << std::endl;
-
-                    // If we get a model at 01:50 we need to correct the SOW down to
-                    // 00:00, because this was the date of issue for this model.
-                    // We calculate the Klobuchar model only on every change of the
-                    // model parameters (every two hours). Otherwise the model
-                    // slightly changes with each new SOW, because it's dependent
-                    // on the local time.
-                    uint32_t secondOfInterval = eph.getSOW() % limit_to_interval_klobuchar;
-                    uint32_t sowFullInterval = eph.getSOW() - secondOfInterval;
-                    bnav::DateTime ephdate { bnav::TimeSystem::BDT, weeknum, sowFullInterval };
-                    bnav::Ionosphere ionoklob(klob, ephdate, generateGlobalKlobuchar);
-
-                    std::cout << klob << std::endl;
-                    //ionoklob.dump();
-
-                    if (limit_to_date && limit_to_date->isSameIonexDay(ionoklob.getDateOfIssue()))
-                    {
-                        std::cout << "add Klobuchar to store for SV: " << sv.getPRN() << " at " << ionoklob.getDateOfIssue().getDateTimeString() << std::endl;
-                        ionostoreKlobuchar.addIonosphere(sv, ionoklob);
-                    }
-
-                    klob_old = klob;
-                }
-            }
+            duplicateCount += merger.getDuplicateCount();
+            repairedWordCount += merger.getRepairedWordCount();
         }
-        else if (sfbuf->isAlmanacComplete())
+        fusionDuplicateCount += shard->fusion.getDuplicateCount();
+        fusionConflictCount += shard->fusion.getConflictCount();
+        fusionLateCount += shard->fusion.getLateCount();
+        if (shard->voter)
         {
-            const bnav::SubframeBufferParam bdata = sfbuf->flushAlmanacData();
-            //std::cout << "almanac complete" << std::endl;
-
-            // only Geos have Ionosphere
-            if (sv.isGeo() && weeknum != 0)
-            {
-                bnav::Ionosphere iono(bdata, weeknum);
-
-                // diff only for one single prn
-                if (limit_to_prn && sv == limit_to_prn.get() && iono.getDateOfIssue().getSOW() % limit_to_interval_regional == 0)
-                {
-                    if (limit_to_date && limit_to_date->isSameIonexDay(iono.getDateOfIssue()))
-                    {
-                        std::cout << "add Regional Grid to store for SV: " << sv.getPRN() << " at " << iono.getDateOfIssue().getDateTimeString() << std::endl;
-                        ionostore.addIonosphere(sv, iono);
-                    }
-
-                    iono_old = iono;
-                }
-            }
+            votedWordCount += shard->voter->getVotedWordCount();
+            votedRepairedWordCount += shard->voter->getRepairedWordCount();
         }
+        hasIncompleteData = hasIncompleteData || shard->sbstore.hasIncompleteData();
+        msgstat.merge(shard->msgstat);
+    }
+
+    std::cout << "Subframe merge: " << duplicateCount << " duplicates, "
+              << repairedWordCount << " repaired words" << std::endl;
+
+    if (filenamesInput.size() > 1)
+    {
+        std::cout << "Subframe fusion: " << fusionDuplicateCount << " duplicates, "
+                  << fusionConflictCount << " conflicts, "
+                  << fusionLateCount << " late" << std::endl;
+    }
+
+    if (vote_depth > 0)
+    {
+        std::cout << "Page vote: " << votedWordCount << " voted words, "
+                  << votedRepairedWordCount << " repaired words" << std::endl;
     }
-    reader.close();
 
-    if (sbstore.hasIncompleteData())
+    if (hasIncompleteData)
         std::cout << "SubframeBufferStore has incomplete data sets at EOF. Ignoring." << std::endl;
 
-    ionostore.dumpStoreStatistics("Regional grid");
-    ionostoreKlobuchar.dumpStoreStatistics("Klobuchar");
+    // no more data, write all days which are still open
+    for (const auto &day2stores : daystores)
+        closeDay(day2stores.first, day2stores.second);
+    daystores.clear();
 
     // dump message statistic
     msgstat.dump();
+}
+
+/**
+ * @brief bnavMain::readBatch Read the next lines of all input files and split
+ * them by shard.
+ *
+ * The files are read in time order of their lines, so the copies of a
+ * subframe from all stations come close together.
+ *
+ * @param streams The input files.
+ * @param batch One vector of lines per shard, cleared first.
+ * @return false, if there are no more lines.
+ */
+bool bnavMain::readBatch(std::vector<InputStream> &streams, std::vector< std::vector<InputLine> > &batch) const
+{
+    for (std::vector<InputLine> &lines : batch)
+        lines.clear();
 
-    // works only with one sv selected at the moment
-    if (limit_to_prn)
+    std::size_t linecount = 0;
+    while (linecount < BATCH_LINES)
     {
-        if (ionostore.hasDataForSv(limit_to_prn.get()))
+        // earliest line, first file on equal time
+        std::size_t station = streams.size();
+        for (std::size_t i = 0; i < streams.size(); ++i)
         {
-            ionostore.dumpGridAvailability(limit_to_prn.get());
+            if (streams[i].hasNext
+                    && (station == streams.size() || streams[i].next.getDateTime() < streams[station].next.getDateTime()))
+                station = i;
+        }
+        if (station == streams.size())
+            break;
+
+        InputStream &stream = streams[station];
+        ++linecount;
 
-            if (!filenameIonexRegional.empty())
-                writeIonexFile(filenameIonexRegional, limit_to_interval_regional, false);
+        const bnav::SvID sv(stream.next.getPRN());
+        if (isSvSelected(sv))
+            batch[getShardIndex(sv)].push_back(InputLine { station, stream.next });
+
+        stream.hasNext = stream.reader->readLine(stream.next);
+    }
+
+    return linecount != 0;
+}
+
+/**
+ * @brief bnavMain::mergeShardModels Move the models of all shards into the
+ * day stores and close the days, which are complete.
+ *
+ * The shards are merged in fixed order after each batch, so the output does
+ * not depend on the number of threads.
+ */
+void bnavMain::mergeShardModels()
+{
+    boost::optional<bnav::DateTime> now;
+    for (const std::unique_ptr<Shard> &shard : shards)
+    {
+        for (ShardModel &model : shard->models)
+        {
+            // keep the storage of unused models
+            if (!addIonosphere(model.sv, model.iono, model.klobuchar))
+                (model.klobuchar ? shard->klobucharPool : shard->regionalPool).release(std::move(model.iono));
         }
+        shard->models.clear();
+
+        if (shard->latestDataSet)
+            lcl_updateLatest(now, *shard->latestDataSet);
+        shard->latestDataSet = boost::none;
+    }
+
+    if (now)
+        closeDays(*now);
+}
+
+/**
+ * @brief bnavMain::processShard Decode the lines of the current batch of a
+ * shard. Touches nothing but the shard, may run in a worker thread.
+ * @param shard The shard.
+ */
+void bnavMain::processShard(Shard &shard) const
+{
+    for (const InputLine &line : shard.lines)
+    {
+        const bnav::SvID sv(line.data.getPRN());
+
+        // D1 or D2 is fixed by PRN, choose the buffer type only once
+        if (sv.isGeo())
+            processSubframe(shard, line.station, sv, line.data.getBits(), shard.sbstore.getSubframeBufferD2(sv));
         else
+            processSubframe(shard, line.station, sv, line.data.getBits(), shard.sbstore.getSubframeBufferD1(sv));
+    }
+}
+
+/**
+ * @brief bnavMain::flushShard Process the subframes of a shard, which were
+ * held back for merging and fusion, at EOF.
+ * @param shard The shard.
+ */
+void bnavMain::flushShard(Shard &shard) const
+{
+    for (bnav::SubframeMerger &merger : shard.mergers)
+    {
+        for (const bnav::SvID &sv : merger.getSvList())
         {
-            std::cout << "No data in Regional Grid store. No Ionex output." << std::endl;
+            shard.mergedSubframes.clear();
+            merger.flush(sv, shard.mergedSubframes);
+
+            if (sv.isGeo())
+                processMergedSubframes(shard, sv, shard.sbstore.getSubframeBufferD2(sv));
+            else
+                processMergedSubframes(shard, sv, shard.sbstore.getSubframeBufferD1(sv));
         }
+    }
+
+    for (const bnav::SvID &sv : shard.fusion.getSvList())
+    {
+        shard.fusedSubframes.clear();
+        shard.fusion.flush(sv, shard.fusedSubframes);
 
-        if (ionostoreKlobuchar.hasDataForSv(limit_to_prn.get()))
+        for (const bnav::Subframe &fsf : shard.fusedSubframes)
         {
-            if (!filenameIonexKlobuchar.empty())
-                writeIonexFile(filenameIonexKlobuchar, limit_to_interval_klobuchar, true);
+            if (sv.isGeo())
+                processDataSets(shard, sv, fsf, shard.sbstore.getSubframeBufferD2(sv));
+            else
+                processDataSets(shard, sv, fsf, shard.sbstore.getSubframeBufferD1(sv));
         }
-        else
+    }
+}
+
+/**
+ * @brief bnavMain::processSubframe Decode one subframe and process the
+ * subframes which leave the merge stage.
+ *
+ * Instantiated for SubframeBufferD1 and SubframeBufferD2, so all calls on the
+ * buffer and the Pnum parser are resolved at compile time.
+ *
+ * @param shard Shard of the SV.
+ * @param station Index of the input file.
+ * @param sv The SvID.
+ * @param bits Raw bits of the subframe.
+ * @param sfbuf SubframeBuffer of the SV.
+ */
+template <typename SubframeBufferT>
+void bnavMain::processSubframe(Shard &shard, const std::size_t station, const SvID &sv, const NavBits<300> &bits, SubframeBufferT &sfbuf) const
+{
+    // decode FraID, SOW and Pnum only, the remaining words are fixed
+    // if the page is needed
+    bnav::Subframe sf;
+    sf.setBits(bits);
+    lcl_initializeHeader(sf, sfbuf);
+
+    // store only messages into stat, if we have a correct BeiDou date
+    const uint32_t weeknum = shard.svstate.contains(sv) ? shard.svstate.get(sv).weeknum : 0;
+    if (weeknum != 0)
+    {
+        const bnav::DateTime bdt = bnav::DateTime(bnav::TimeSystem::BDT, weeknum, sf.getSOW());
+        shard.msgstat.add(sv, bdt);
+    }
+
+    if (!pagefilter.isRequired(sv, sf))
+        return;
+
+    sf.initializeData();
+
+    // B1 and B2 copies of one subframe are forwarded only once
+    shard.mergedSubframes.clear();
+    shard.mergers[station].add(sv, sf, shard.mergedSubframes);
+
+    processMergedSubframes(shard, sv, sfbuf);
+}
+
+/**
+ * @brief bnavMain::processMergedSubframes Process the subframes, which left
+ * the merge stage of one station. With more than one station they pass the
+ * fusion stage first.
+ *
+ * @param shard Shard of the SV.
+ * @param sv The SvID.
+ * @param sfbuf SubframeBuffer of the SV.
+ */
+template <typename SubframeBufferT>
+void bnavMain::processMergedSubframes(Shard &shard, const SvID &sv, SubframeBufferT &sfbuf) const
+{
+    if (shard.mergers.size() == 1)
+    {
+        for (const bnav::Subframe &msf : shard.mergedSubframes)
+            processDataSets(shard, sv, msf, sfbuf);
+        return;
+    }
+
+    shard.fusedSubframes.clear();
+    for (const bnav::Subframe &msf : shard.mergedSubframes)
+        shard.fusion.add(sv, msf, shard.fusedSubframes);
+
+    for (const bnav::Subframe &fsf : shard.fusedSubframes)
+        processDataSets(shard, sv, fsf, sfbuf);
+}
+
+/**
+ * @brief bnavMain::processDataSets Add a merged subframe to its buffer and
+ * process all data sets it completes. New models are collected in the shard.
+ *
+ * @param shard Shard of the SV.
+ * @param sv The SvID.
+ * @param sf Merged and fully initialized Subframe.
+ * @param sfbuf SubframeBuffer of the SV.
+ */
+template <typename SubframeBufferT>
+void bnavMain::processDataSets(Shard &shard, const SvID &sv, const Subframe &sf, SubframeBufferT &sfbuf) const
+{
+    if (shard.voter)
+    {
+        bnav::Subframe voted { sf };
+        shard.voter->repair(sv, voted);
+        sfbuf.addSubframe(voted);
+    }
+    else
+    {
+        sfbuf.addSubframe(sf);
+    }
+    SvState &state = shard.svstate.insert(sv);
+
+    if (sfbuf.isEphemerisComplete())
+    {
+        const bnav::SubframeBufferParam bdata = sfbuf.flushEphemerisData();
+        //std::cout << "eph complete" << std::endl;
+
+        // Model is updated at every full two hour (00:00, 02:00, 04:00,...).
+        // Try to get at least one model within this time frame. It may
+        // be the case, that there is no data until 01:50, but with this
+        // we can grep the model within the last 10 minutes of transmission.
+        // The SOW of the first page is the SOW of the ephemeris, so the
+        // data set needs to be parsed only once per interval.
+        const uint32_t ephsow { bdata.data[0].front().getSOW() };
+        if (state.weeknum != 0)
+            lcl_updateLatest(shard.latestDataSet, bnav::DateTime(bnav::TimeSystem::BDT, state.weeknum, ephsow));
+
+        const uint32_t modelInterval { getKlobucharModelInterval() };
+        uint32_t intervalCount = ephsow / modelInterval;
+        if (state.weeknum != 0 && intervalCount == state.klobucharIntervalCount)
+            return;
+
+        bnav::Ephemeris eph(bdata);
+        // store weeknum, because it's only present in Ephemeris data, we
+        // need this for Ionosphere, too.
+        state.weeknum = eph.getWeekNum();
+
+        // Each SV has its own models, with --consensus the models of all
+        // GEOs are fused when they are added to the day stores.
+        if (intervalCount != state.klobucharIntervalCount)
+        {
+            state.klobucharIntervalCount = intervalCount;
+            bnav::KlobucharParam klob = eph.getKlobucharParam();
+
+            // Take only one new model.
+            if (klob != state.klobucharParam)
+            {
+                std::cout << "New Klobuchar Model at SOW: " << eph.getSOW() << std::endl;
+
+                // If we get a model at 01:50 we need to correct the SOW down to
+                // 00:00, because this was the date of issue for this model.
+                // We calculate the Klobuchar model only on every change of the
+                // model parameters (every two hours). Otherwise the model
+                // slightly changes with each new SOW, because it's dependent
+                // on the local time.
+                uint32_t secondOfInterval = eph.getSOW() % modelInterval;
+                uint32_t sowFullInterval = eph.getSOW() - secondOfInterval;
+                bnav::DateTime ephdate { bnav::TimeSystem::BDT, state.weeknum, sowFullInterval };
+                bnav::Ionosphere ionoklob { shard.klobucharPool.acquire() };
+                ionoklob.load(klob, ephdate, generateGlobalKlobuchar);
+
+                std::cout << klob << std::endl;
+                //ionoklob.dump();
+
+                shard.models.push_back(ShardModel { sv, std::move(ionoklob), true });
+
+                state.klobucharParam = klob;
+            }
+        }
+    }
+    else if (sfbuf.isAlmanacComplete())
+    {
+        const bnav::SubframeBufferParam bdata = sfbuf.flushAlmanacData();
+        //std::cout << "almanac complete" << std::endl;
+
+        // only Geos have Ionosphere
+        if (sv.isGeo() && state.weeknum != 0)
+        {
+            bnav::Ionosphere iono { shard.regionalPool.acquire() };
+            iono.load(bdata, state.weeknum);
+            lcl_updateLatest(shard.latestDataSet, iono.getDateOfIssue());
+
+            if (iono.getDateOfIssue().getSOW() % limit_to_interval_regional == 0)
+                shard.models.push_back(ShardModel { sv, std::move(iono), false });
+            else
+                shard.regionalPool.release(std::move(iono));
+        }
+    }
+}
+
+/**
+ * @brief bnavMain::isSvSelected Check if a SV has to be processed.
+ * @param sv The SvID.
+ * @return true, if selected by --sv or if there was no --sv at all.
+ */
+bool bnavMain::isSvSelected(const SvID &sv) const
+{
+    return limit_to_prn.test(sv.getPRN() - 1);
+}
+
+/**
+ * @brief bnavMain::getShardIndex Get the shard, which decodes a SV.
+ * @param sv The SvID.
+ * @return Index into shards.
+ */
+std::size_t bnavMain::getShardIndex(const SvID &sv) const
+{
+    return (sv.getPRN() - 1) % shards.size();
+}
+
+/**
+ * @brief bnavMain::isDaySelected Check if Ionex output is requested for a day.
+ * @param day The day.
+ * @return true, if within --date limits or if there is no limit at all.
+ */
+bool bnavMain::isDaySelected(const boost::gregorian::date &day) const
+{
+    if (limit_to_date_first && day < *limit_to_date_first)
+        return false;
+    if (limit_to_date_last && day > *limit_to_date_last)
+        return false;
+    return true;
+}
+
+/**
+ * @brief bnavMain::isMultiDay Check if more than one day may be written.
+ * @return true, for a range of days or all days.
+ */
+bool bnavMain::isMultiDay() const
+{
+    return !limit_to_date_first || *limit_to_date_first != *limit_to_date_last;
+}
+
+/**
+ * @brief bnavMain::getKlobucharModelInterval Get the interval, to which the
+ * date of a Klobuchar model is set down.
+ * @return The Klobuchar interval, at least the update interval of the model.
+ */
+std::uint32_t bnavMain::getKlobucharModelInterval() const
+{
+    return std::max(limit_to_interval_klobuchar, KLOBUCHAR_UPDATE_INTERVAL);
+}
+
+/**
+ * @brief bnavMain::addIonosphere Add a model to the stores of its days.
+ *
+ * Ionex: 20131201 00:00:00 till 20131202 00:00:00 is one day, so a model at
+ * 00:00:00 belongs to two days.
+ *
+ * @param sv The SvID.
+ * @param iono The model, moved into the store if taken.
+ * @param klobuchar Klobuchar model, else regional grid.
+ * @return true, if the model was taken by a day store.
+ */
+bool bnavMain::addIonosphere(const SvID &sv, Ionosphere &iono, const bool klobuchar)
+{
+    const boost::posix_time::ptime issue { iono.getDateOfIssue().get_ptime() };
+    const std::array<boost::gregorian::date, 2> days {{ issue.date(), issue.date() - boost::gregorian::days(1) }};
+    const std::size_t daycount = issue.time_of_day().ticks() == 0 ? 2 : 1;
+
+    std::array<DayStores*, 2> stores {{ nullptr, nullptr }};
+    std::size_t storecount = 0;
+    for (std::size_t i = 0; i < daycount; ++i)
+    {
+        if (!isDaySelected(days[i]))
+            continue;
+
+        // files of closed days are written already
+        if (!lastClosedDay.is_not_a_date() && days[i] <= lastClosedDay)
+        {
+            std::cout << "Ignoring model for closed day: " << boost::gregorian::to_iso_string(days[i]) << std::endl;
+            continue;
+        }
+
+        std::cout << "add " << (klobuchar ? "Klobuchar" : "Regional Grid") << " to store for SV: " << sv.getPRN() << " at " << iono.getDateOfIssue().getDateTimeString() << std::endl;
+        stores[storecount++] = &daystores[days[i]];
+    }
+
+    if (storecount == 0)
+        return false;
+
+    if (consensus && sv.isGeo())
+    {
+        // copy only for the second day, copies of other GEOs are dropped
+        if (storecount == 2)
+        {
+            bnav::Ionosphere ionocopy { iono };
+            (klobuchar ? stores[1]->klobucharConsensus : stores[1]->regionalConsensus).addIonosphere(sv, ionocopy);
+        }
+        return (klobuchar ? stores[0]->klobucharConsensus : stores[0]->regionalConsensus).addIonosphere(sv, iono);
+    }
+
+    // copy only for the second day
+    if (storecount == 2)
+        (klobuchar ? stores[1]->klobuchar : stores[1]->regional).addIonosphere(sv, iono);
+    (klobuchar ? stores[0]->klobuchar : stores[0]->regional).addIonosphere(sv, std::move(iono));
+    return true;
+}
+
+/**
+ * @brief bnavMain::closeDays Write and drop all days, which cannot get new
+ * models anymore.
+ *
+ * A Klobuchar model is dated down to its interval, so it may be found up to
+ * one interval later. Regional grids need one D2 frame 5 period (6 min).
+ *
+ * @param now Time of the current data set.
+ */
+void bnavMain::closeDays(const DateTime &now)
+{
+    const boost::posix_time::time_duration margin { boost::posix_time::seconds(getKlobucharModelInterval() + 360) };
+
+    while (!daystores.empty())
+    {
+        const auto first = daystores.begin();
+        const boost::posix_time::ptime dayend { first->first + boost::gregorian::days(1) };
+        if (now.get_ptime() < dayend + margin)
+            break;
+
+        closeDay(first->first, first->second);
+        recycleDay(first->second);
+        lastClosedDay = first->first;
+        daystores.erase(first);
+    }
+}
+
+/**
+ * @brief bnavMain::recycleDay Give the models of a written day back to the
+ * pools of their shards. Workers must not run meanwhile.
+ * @param stores Models of the day.
+ */
+void bnavMain::recycleDay(DayStores &stores)
+{
+    for (const SvID &sv : stores.regional.getSvList())
+        stores.regional.recycle(sv, shards[getShardIndex(sv)]->regionalPool);
+    for (const SvID &sv : stores.klobuchar.getSvList())
+        stores.klobuchar.recycle(sv, shards[getShardIndex(sv)]->klobucharPool);
+
+    // any pool may take them, the first shard decodes PRN 1
+    stores.regionalConsensus.recycle(shards.front()->regionalPool);
+    stores.klobucharConsensus.recycle(shards.front()->klobucharPool);
+}
+
+/**
+ * @brief bnavMain::closeDay Dump statistics and write the Ionex files of a day.
+ * @param day The day.
+ * @param stores Models of the day.
+ */
+void bnavMain::closeDay(const boost::gregorian::date &day, const DayStores &stores)
+{
+    std::cout << "Closing day: " << boost::gregorian::to_iso_string(day) << std::endl;
+
+    stores.regional.dumpStoreStatistics("Regional grid");
+    stores.klobuchar.dumpStoreStatistics("Klobuchar");
+    if (consensus)
+    {
+        stores.regionalConsensus.dump("Regional grid");
+        stores.klobucharConsensus.dump("Klobuchar");
+    }
+
+    writeIonexFiles(stores.regional, stores.regionalConsensus, false, day);
+    writeIonexFiles(stores.klobuchar, stores.klobucharConsensus, true, day);
+}
+
+/**
+ * @brief bnavMain::writeIonexFiles Write one Ionex file for each SV with data
+ * and one for the consensus of all GEOs.
+ *
+ * If more than one SV is selected, the PRN is added to the filename of each
+ * SV, but not to the one of the consensus. If more than one day is selected,
+ * the date is added.
+ *
+ * @param store Models of the day.
+ * @param consensusStore Consensus models of the day.
+ * @param klobuchar Write Klobuchar models, else regional grids.
+ * @param day The day.
+ */
+void bnavMain::writeIonexFiles(const IonosphereStore &store, const IonosphereConsensus &consensusStore, const bool klobuchar, const boost::gregorian::date &day)
+{
+    const std::string &filename = klobuchar ? filenameIonexKlobuchar : filenameIonexRegional;
+    const bool addPrnSuffix { limit_to_prn.count() > 1 };
+
+    std::size_t svcount = 0;
+    for (const SvID &sv : store.getSvList())
+    {
+        if (!store.hasDataForSv(sv))
+            continue;
+
+        if (!klobuchar)
+            store.dumpGridAvailability(sv);
+
+        if (!filename.empty())
+        {
+            std::stringstream suffix;
+            if (addPrnSuffix)
+                suffix << "-prn" << std::setw(2) << std::setfill('0') << sv.getPRN();
+            if (isMultiDay())
+                suffix << "-" << boost::gregorian::to_iso_string(day);
+
+            // write all models from prn
+            const auto prn2data = store.getItemsBySv(sv);
+            if (prn2data)
+                writeIonexFile(lcl_addFilenameSuffix(filename, suffix.str()), prn2data.get(), klobuchar, day);
+            else
+                std::cerr << "writeIonexFiles: no data for getItemsBySv!" << std::endl;
+        }
+
+        ++svcount;
+    }
+
+    if (!consensusStore.empty())
+    {
+        const TimeSeries<Ionosphere> &items = consensusStore.getItems();
+        if (!klobuchar)
+            IonosphereStore::dumpGridAvailability(items);
+
+        if (!filename.empty())
         {
-            std::cout << "No data in Klobuchar store. No Ionex output." << std::endl;
+            const std::string suffix { isMultiDay() ? "-" + boost::gregorian::to_iso_string(day) : "" };
+            writeIonexFile(lcl_addFilenameSuffix(filename, suffix), items, klobuchar, day);
         }
+
+        ++svcount;
     }
+
+    if (svcount == 0)
+        std::cout << "No data in " << (klobuchar ? "Klobuchar" : "Regional Grid") << " store. No Ionex output." << std::endl;
 }
 
-void bnavMain::writeIonexFile(const std::string &filename, const std::uint32_t interval, const bool klobuchar)
+/**
+ * @brief bnavMain::writeIonexFile Write the models of one SV or the consensus
+ * of one day.
+ *
+ * Klobuchar models are evaluated at the grid and interval of the output, maps
+ * after the day are left to the next day.
+ *
+ * @param filename Ionex filename.
+ * @param items Models by date of issue.
+ * @param klobuchar Klobuchar models, else regional grids.
+ * @param day The day.
+ */
+void bnavMain::writeIonexFile(const std::string &filename, const TimeSeries<Ionosphere> &items, const bool klobuchar, const boost::gregorian::date &day)
 {
     std::cout << "Writing Ionex file: " << filename << std::endl;
-    assert(limit_to_prn); // atm we can only store data from one prn
     // overwrites without warnings
-    bnav::IonexWriter writer(filename, interval, klobuchar);
+    bnav::IonexWriter writer(filename, klobuchar ? limit_to_interval_klobuchar : limit_to_interval_regional, klobuchar);
     if (!writer.isOpen())
         std::perror(("Error: Could not open file: " + filename).c_str());
 
-    // write all models from prn
-    const auto prn2data = klobuchar ? ionostoreKlobuchar.getItemsBySv(limit_to_prn.get()) : ionostore.getItemsBySv(limit_to_prn.get());
-    if (prn2data)
-        writer.writeAll(prn2data.get());
+    if (klobuchar)
+    {
+        const bnav::KlobucharMapGenerator generator(getKlobucharGridDimension(generateGlobalKlobuchar, klobuchar_latspacing, klobuchar_longspacing),
+                                                    limit_to_interval_klobuchar, getKlobucharModelInterval(), threadcount);
+        const boost::posix_time::ptime dayend { day + boost::gregorian::days(1) };
+        generator.write(items, dayend, writer);
+    }
     else
-        std::cerr << "writeIonexFile: no data for getItemsBySv!" << std::endl;
+    {
+        writer.writeAll(items);
+    }
     writer.close();
 }
 
@@ -2,12 +2,29 @@
 #define BNAVMAIN_H
 
 #include "AsciiReader.h"
+#include "BeiDou.h"
+#include "Ephemeris.h"
+#include "IonosphereConsensus.h"
+#include "IonospherePool.h"
 #include "IonosphereStore.h"
+#include "MessageStatistic.h"
+#include "NavBits.h"
+#include "PageFilter.h"
+#include "PageVoter.h"
 #include "SubframeBufferStore.h"
+#include "SubframeFusion.h"
+#include "SubframeMerger.h"
+#include "SvArray.h"
 #include "SvID.h"
 
+#include <bitset>
+#include <limits>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include <boost/date_time/gregorian/gregorian_types.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/optional.hpp>
 
@@ -16,7 +33,7 @@ namespace bnav
 
 class bnavMain final: public boost::noncopyable
 {
-    std::string filenameInput;
+    std::vector<std::string> filenamesInput; ///< one per station
     bnav::AsciiReaderType filetypeInput;
     std::string filenameIonexKlobuchar;
     std::string filenameIonexRegional;
@@ -24,12 +41,93 @@ class bnavMain final: public boost::noncopyable
     bool generateGlobalKlobuchar;
     std::uint32_t limit_to_interval_regional;
     std::uint32_t limit_to_interval_klobuchar;
-    boost::optional<SvID> limit_to_prn;
-    boost::optional<DateTime> limit_to_date;
+    double klobuchar_latspacing; ///< grid of Klobuchar maps [deg]
+    double klobuchar_longspacing;
+    std::bitset<BDS_MAX_PRN> limit_to_prn; ///< selected SVs, bit 0 is PRN 1
+    boost::optional<boost::gregorian::date> limit_to_date_first; ///< none for no limit
+    boost::optional<boost::gregorian::date> limit_to_date_last; ///< none for no limit
 
-    bnav::SubframeBufferStore sbstore;
-    bnav::IonosphereStore ionostore;
-    bnav::IonosphereStore ionostoreKlobuchar;
+    std::size_t threadcount;
+    std::uint32_t fusion_window;
+    std::size_t vote_depth; ///< 0 for no page vote
+    bool consensus; ///< one product of all GEOs
+
+    bnav::PageFilter pagefilter;
+
+    /// decoding state of one SV
+    struct SvState
+    {
+        uint32_t weeknum; ///< only present in ephemeris data, needed for Ionosphere, too
+        uint32_t klobucharIntervalCount;
+        bnav::KlobucharParam klobucharParam; ///< last Klobuchar model
+
+        SvState()
+            : weeknum(0)
+            , klobucharIntervalCount(std::numeric_limits<uint32_t>::max())
+            , klobucharParam()
+        {
+        }
+    };
+
+    /// line of one input file
+    struct InputLine
+    {
+        std::size_t station;
+        bnav::AsciiReaderEntry data;
+    };
+
+    /// input file with its next line, to read all files in time order
+    struct InputStream
+    {
+        std::unique_ptr<bnav::AsciiReader> reader;
+        bnav::AsciiReaderEntry next;
+        bool hasNext;
+    };
+
+    /// model decoded by a Shard
+    struct ShardModel
+    {
+        bnav::SvID sv;
+        bnav::Ionosphere iono;
+        bool klobuchar;
+    };
+
+    /**
+     * Decoding state of a group of SVs. All state of one SV is in the same
+     * Shard, so the Shards can be processed in parallel.
+     */
+    struct Shard
+    {
+        std::vector<InputLine> lines; ///< input of the current batch
+        bnav::SvArray<SvState> svstate;
+        bnav::MessageStatistic msgstat;
+        std::vector<bnav::SubframeMerger> mergers; ///< one per station
+        std::vector<bnav::Subframe> mergedSubframes;
+        bnav::SubframeFusion fusion; ///< of all stations
+        std::vector<bnav::Subframe> fusedSubframes;
+        std::unique_ptr<bnav::PageVoter> voter; ///< none without --vote
+        bnav::SubframeBufferStore sbstore;
+        bnav::IonospherePool regionalPool; ///< storage of unused grids
+        bnav::IonospherePool klobucharPool; ///< separate, global grids are larger
+        std::vector<ShardModel> models; ///< output of the current batch
+        boost::optional<DateTime> latestDataSet; ///< of the current batch
+
+        Shard(const std::size_t stationcount, const std::uint32_t window, const std::size_t votedepth);
+    };
+
+    std::vector< std::unique_ptr<Shard> > shards;
+
+    /// models of one Ionex day
+    struct DayStores
+    {
+        bnav::IonosphereStore regional;
+        bnav::IonosphereStore klobuchar;
+        bnav::IonosphereConsensus regionalConsensus; ///< of all GEOs, only with --consensus
+        bnav::IonosphereConsensus klobucharConsensus;
+    };
+
+    std::map<boost::gregorian::date, DayStores> daystores; ///< open days only
+    boost::gregorian::date lastClosedDay;
 
 public:
     bnavMain(int argc, char *argv[]);
@@ -37,7 +135,31 @@ public:
     void readInputFile();
 
 private:
-    void writeIonexFile(const std::string &filename, const std::uint32_t interval, const bool klobuchar);
+    bool readBatch(std::vector<InputStream> &streams, std::vector< std::vector<InputLine> > &batch) const;
+    void mergeShardModels();
+
+    void processShard(Shard &shard) const;
+    void flushShard(Shard &shard) const;
+    template <typename SubframeBufferT>
+    void processSubframe(Shard &shard, const std::size_t station, const SvID &sv, const NavBits<300> &bits, SubframeBufferT &sfbuf) const;
+    template <typename SubframeBufferT>
+    void processMergedSubframes(Shard &shard, const SvID &sv, SubframeBufferT &sfbuf) const;
+    template <typename SubframeBufferT>
+    void processDataSets(Shard &shard, const SvID &sv, const Subframe &sf, SubframeBufferT &sfbuf) const;
+
+    bool isSvSelected(const SvID &sv) const;
+    std::size_t getShardIndex(const SvID &sv) const;
+    bool isDaySelected(const boost::gregorian::date &day) const;
+    bool isMultiDay() const;
+    std::uint32_t getKlobucharModelInterval() const;
+
+    bool addIonosphere(const SvID &sv, Ionosphere &iono, const bool klobuchar);
+    void closeDays(const DateTime &now);
+    void closeDay(const boost::gregorian::date &day, const DayStores &stores);
+    void recycleDay(DayStores &stores);
+
+    void writeIonexFiles(const IonosphereStore &store, const IonosphereConsensus &consensusStore, const bool klobuchar, const boost::gregorian::date &day);
+    void writeIonexFile(const std::string &filename, const TimeSeries<Ionosphere> &items, const bool klobuchar, const boost::gregorian::date &day);
 };
 
 } // namespace bnav
@@ -5,7 +5,7 @@
 TEMPLATE = app
 TARGET = bapp
 
-CONFIG += console
+CONFIG += console thread
 CONFIG -= app_bundle
 
 LIBS += -L../lib -lbnav -lboost_program_options -lboost_regex
@@ -0,0 +1,51 @@
+#ifndef TESTHELPER_H
+#define TESTHELPER_H
+
+#include "AsciiReader.h"
+#include "BeiDou.h"
+#include "Ephemeris.h"
+#include "Subframe.h"
+#include "SvID.h"
+
+#include <string>
+#include <vector>
+
+namespace bnavtest
+{
+
+/// Klobuchar parameters of a typical broadcast, alpha0 may be varied
+/// to tell models apart
+inline bnav::KlobucharParam getKlobucharParam(const double alpha0 = 1.6764e-08)
+{
+    bnav::KlobucharParam klob;
+    klob.alpha0 = alpha0;
+    klob.alpha1 = 3.7253e-07;
+    klob.alpha2 = -2.7418e-06;
+    klob.alpha3 = 4.6492e-06;
+    klob.beta0 = 1.3517e+05;
+    klob.beta1 = -5.5706e+05;
+    klob.beta2 = 4.1288e+06;
+    klob.beta3 = -2.9491e+06;
+    return klob;
+}
+
+/// All B1 subframes of a converted SBF file in the order they were received
+inline std::vector<bnav::Subframe> readSubframesB1(const std::string &filename)
+{
+    bnav::AsciiReader reader(filename, bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+    std::vector<bnav::Subframe> subframes;
+    bnav::AsciiReaderEntry entry;
+    while (reader.readLine(entry))
+    {
+        if (entry.getSignalType() == bnav::SignalType::BDS_B1)
+            subframes.push_back(bnav::Subframe(bnav::SvID(entry.getPRN()), entry.getBits()));
+    }
+    reader.close();
+
+    return subframes;
+}
+
+} // namespace bnavtest
+
+#endif // TESTHELPER_H
@@ -5,7 +5,10 @@
 
 #include "AsciiReader.h"
 #include "BeiDou.h"
+#include "IonosphereGrid.h"
 #include "NavBits.h"
+#include "Subframe.h"
+#include "SubframeBuffer.h"
 #include "SvID.h"
 
 #include <iostream>
@@ -84,3 +87,43 @@ TEST(testIonoGridDimension)
         CHECK_EQUAL(289, igd.getItemCountLongitude());
     }
 }
+
+TEST(testIonosphere_DecodeRegionalGrid)
+{
+    bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                             bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+    bnav::SubframeBufferD2 sfbuf(bnav::D2AlmanacPages::IONOSPHERE);
+    bnav::Ionosphere iono;
+    bnav::AsciiReaderEntry entry;
+    while (reader.readLine(entry))
+    {
+        if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+            continue;
+
+        sfbuf.addSubframe(bnav::Subframe(bnav::SvID(entry.getPRN()), entry.getBits()));
+        if (sfbuf.isAlmanacComplete())
+            iono.load(sfbuf.flushAlmanacData(), 0);
+    }
+    CHECK(iono.hasData());
+
+    // european order, north west first
+    const bnav::IonoGrid grid { iono.getGrid() };
+    std::size_t unavailable = 0;
+    uint32_t dtsum = 0, givesum = 0;
+    for (std::size_t i = 0; i < grid.size(); ++i)
+    {
+        if (grid.getVerticalDelay_TECU(i) == 9999)
+        {
+            ++unavailable;
+            continue;
+        }
+        dtsum += grid.getVerticalDelay_TECU(i);
+        givesum += grid.getGive_TECU(i);
+    }
+    CHECK_EQUAL(217, unavailable);
+    CHECK_EQUAL(18262, dtsum);
+    CHECK_EQUAL(9845, givesum);
+    CHECK_EQUAL(181, grid.getVerticalDelay_TECU(9 * 16 + 9));
+    CHECK_EQUAL(159, grid.getVerticalDelay_TECU(4 * 16 + 3));
+}
@@ -0,0 +1,80 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "IonosphereConsensus.h"
+
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "Ionosphere.h"
+#include "IonospherePool.h"
+#include "SvID.h"
+
+// each SV misses one epoch, the consensus has all of them
+TEST(testIonosphereConsensus_FillGaps)
+{
+    const bnav::KlobucharParam klob { bnavtest::getKlobucharParam() };
+    const bnav::DateTime dt0(bnav::TimeSystem::BDT, 452, 0);
+    const bnav::DateTime dt1(bnav::TimeSystem::BDT, 452, 7200);
+    const bnav::DateTime dt2(bnav::TimeSystem::BDT, 452, 14400);
+
+    bnav::IonosphereConsensus consensus;
+    CHECK(consensus.empty());
+
+    bnav::Ionosphere iono(klob, dt0);
+    CHECK(consensus.addIonosphere(bnav::SvID(1), iono));
+    iono = bnav::Ionosphere(klob, dt1);
+    CHECK(consensus.addIonosphere(bnav::SvID(1), iono));
+
+    // copies are not taken
+    iono = bnav::Ionosphere(klob, dt1);
+    CHECK(!consensus.addIonosphere(bnav::SvID(2), iono));
+    CHECK(iono.hasData());
+    iono = bnav::Ionosphere(klob, dt2);
+    CHECK(consensus.addIonosphere(bnav::SvID(2), iono));
+
+    CHECK_EQUAL(3, consensus.getEpochCount());
+    CHECK_EQUAL(1, consensus.getCopyCount());
+    CHECK_EQUAL(0, consensus.getConflictCount());
+
+    const bnav::TimeSeries<bnav::Ionosphere> &items = consensus.getItems();
+    CHECK_EQUAL(3, items.size());
+    CHECK(items.at(dt1) == bnav::Ionosphere(klob, dt1));
+
+    bnav::IonospherePool pool;
+    consensus.recycle(pool);
+    CHECK(consensus.empty());
+    CHECK_EQUAL(3, pool.getFreeCount());
+}
+
+// the model of most SVs wins a conflict, on a tie the lowest PRN
+TEST(testIonosphereConsensus_Conflict)
+{
+    const bnav::KlobucharParam klob { bnavtest::getKlobucharParam() };
+    bnav::KlobucharParam klobother { klob };
+    klobother.alpha0 *= 2;
+    const bnav::DateTime dt(bnav::TimeSystem::BDT, 452, 7200);
+
+    const bnav::Ionosphere ionoref(klob, dt);
+    const bnav::Ionosphere ionoother(klobother, dt);
+    CHECK(!(ionoref == ionoother));
+
+    bnav::IonosphereConsensus consensus;
+    bnav::Ionosphere iono { ionoother };
+    CHECK(consensus.addIonosphere(bnav::SvID(3), iono));
+    iono = ionoref;
+    CHECK(consensus.addIonosphere(bnav::SvID(4), iono));
+    CHECK_EQUAL(1, consensus.getConflictCount());
+    CHECK(consensus.getItems().at(dt) == ionoother);
+
+    iono = ionoref;
+    CHECK(!consensus.addIonosphere(bnav::SvID(5), iono));
+    CHECK(consensus.getItems().at(dt) == ionoref);
+
+    iono = ionoother;
+    CHECK(!consensus.addIonosphere(bnav::SvID(1), iono));
+    CHECK(consensus.getItems().at(dt) == ionoother);
+
+    CHECK_EQUAL(1, consensus.getEpochCount());
+    CHECK_EQUAL(2, consensus.getCopyCount());
+}
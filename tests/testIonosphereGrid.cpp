@@ -0,0 +1,63 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+
+#include "IonosphereGrid.h"
+#include "IonosphereGridInfo.h"
+
+#include <vector>
+
+TEST(testIonoGrid_Cells)
+{
+    bnav::IonoGrid grid;
+    CHECK(grid.empty());
+
+    grid.push_back(bnav::IonoGridInfo(100, 20));
+    grid.push_back(bnav::IonoGridInfo(9999, 9999));
+    grid.push_back(bnav::IonoGridInfo());
+    CHECK_EQUAL(3, grid.size());
+
+    CHECK_EQUAL(100, grid.getVerticalDelay_TECU(0));
+    CHECK_EQUAL(20, grid.getGive_TECU(0));
+    CHECK(grid[0] == bnav::IonoGridInfo(100, 20));
+    CHECK(grid[1] == bnav::IonoGridInfo(9999, 9999));
+
+    // a cell, which was never set, is not valid
+    CHECK(!grid[2].isValid());
+    CHECK_EQUAL(bnav::IonoGrid::IONOGRID_UNSET, grid.getVerticalDelayData()[2]);
+
+    grid.setVerticalDelay_TECU(2, 0);
+    CHECK(grid[2].isValid());
+    CHECK_EQUAL(0, grid.getVerticalDelay_TECU(2));
+
+    grid.set(0, bnav::IonoGridInfo(5, 6));
+    CHECK_EQUAL(5, grid.getVerticalDelayData()[0]);
+    CHECK_EQUAL(6, grid.getGiveData()[0]);
+
+    // storage of a cleared grid is reused, new cells are unset
+    grid.clear();
+    grid.resize(2);
+    CHECK_EQUAL(2, grid.size());
+    CHECK(!grid[0].isValid());
+}
+
+TEST(testIonoGrid_Operators)
+{
+    const std::vector<bnav::IonoGridInfo> cells1 { bnav::IonoGridInfo(100, 100), bnav::IonoGridInfo(9999, 100), bnav::IonoGridInfo(0, 9999) };
+    const std::vector<bnav::IonoGridInfo> cells2 { bnav::IonoGridInfo(50, 150), bnav::IonoGridInfo(100, 100), bnav::IonoGridInfo(0, 20) };
+    const bnav::IonoGrid grid1(cells1);
+    const bnav::IonoGrid grid2(cells2);
+
+    CHECK(grid1 == bnav::IonoGrid(cells1));
+    CHECK(!(grid1 == grid2));
+
+    // same as for each IonoGridInfo
+    const bnav::IonoGrid diff { grid1 - grid2 };
+    CHECK_EQUAL(3, diff.size());
+    for (std::size_t i = 0; i < diff.size(); ++i)
+        CHECK(diff[i] == cells1[i] - cells2[i]);
+
+    const bnav::IonoGrid filled(4, bnav::IonoGridInfo(9999));
+    CHECK_EQUAL(4, filled.size());
+    CHECK_EQUAL(9999, filled.getVerticalDelay_TECU(3));
+    CHECK_EQUAL(0, filled.getGive_TECU(3));
+}
@@ -0,0 +1,106 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+
+#include "IonosphereInterpolator.h"
+
+#include "DateTime.h"
+#include "Ionosphere.h"
+#include "IonosphereGrid.h"
+#include "IonosphereGridInfo.h"
+#include "TimeSeriesStore.h"
+
+#include <vector>
+
+namespace
+{
+
+// regional grid with delay 10 * row + col + offset
+bnav::Ionosphere lcl_getLinearGrid(const uint32_t sow, const uint32_t offset)
+{
+    std::vector<bnav::IonoGridInfo> grid;
+    for (uint32_t row = 0; row < 20; ++row)
+        for (uint32_t col = 0; col < 16; ++col)
+            grid.push_back(bnav::IonoGridInfo(10 * row + col + offset));
+
+    bnav::Ionosphere iono;
+    iono.setGrid(grid);
+    iono.setGridDimension(bnav::IonoGridDimension(55.0, 7.5, -2.5, 70.0, 145.0, 5.0));
+    iono.setDateOfIssue(bnav::DateTime(bnav::TimeSystem::BDT, 452, sow));
+    return iono;
+}
+
+}
+
+TEST(testIonosphereInterpolator_Space)
+{
+    bnav::TimeSeries<bnav::Ionosphere> items;
+    items.insert(bnav::DateTime(bnav::TimeSystem::BDT, 452, 0), lcl_getLinearGrid(0, 0));
+    bnav::IonosphereInterpolator interpolator(items);
+    CHECK(!interpolator.empty());
+
+    const double t { bnav::IonosphereInterpolator::getTime(bnav::DateTime(bnav::TimeSystem::BDT, 452, 0)) };
+    // IGP, cell center, south east corner, west of the grid, north of the grid
+    const std::vector<double> lat { 55.0, 41.25, 7.5, 30.0, 56.0 };
+    const std::vector<double> lon { 70.0, 97.5, 145.0, 65.0, 100.0 };
+    const std::vector<double> time(lat.size(), t);
+
+    std::vector<double> delay;
+    CHECK_EQUAL(3, interpolator.evaluate(lat, lon, time, delay));
+    CHECK_EQUAL(lat.size(), delay.size());
+    CHECK_CLOSE(0.0, delay[0], 1e-9);
+    CHECK_CLOSE(10 * 5.5 + 5.5, delay[1], 1e-9);
+    CHECK_CLOSE(10 * 19 + 15, delay[2], 1e-9);
+    CHECK_EQUAL(9999.0, delay[3]);
+    CHECK_EQUAL(9999.0, delay[4]);
+}
+
+TEST(testIonosphereInterpolator_MissingIGP)
+{
+    bnav::Ionosphere iono { lcl_getLinearGrid(0, 0) };
+    bnav::IonoGrid grid { iono.getGrid() };
+    // row 2, col 2 and row 10, cols 2 and 3
+    grid.set(2 * 16 + 2, bnav::IonoGridInfo(9999));
+    grid.set(10 * 16 + 2, bnav::IonoGridInfo(9999));
+    grid.set(10 * 16 + 3, bnav::IonoGridInfo(9999));
+    iono.setGrid(grid);
+
+    bnav::IonosphereInterpolator interpolator;
+    interpolator.addIonosphere(iono);
+
+    const double t { bnav::IonosphereInterpolator::getTime(iono.getDateOfIssue()) };
+    // center of the cells south east of the missing IGPs, the missing IGP itself
+    const std::vector<double> lat { 55.0 - 2.5 * 2.5, 55.0 - 10.5 * 2.5, 55.0 - 2 * 2.5 };
+    const std::vector<double> lon { 70.0 + 2.5 * 5.0, 70.0 + 2.5 * 5.0, 70.0 + 2 * 5.0 };
+    const std::vector<double> time(lat.size(), t);
+
+    std::vector<double> delay;
+    CHECK_EQUAL(1, interpolator.evaluate(lat, lon, time, delay));
+    // three IGPs left with the same weight
+    CHECK_CLOSE((23.0 + 32.0 + 33.0) / 3.0, delay[0], 1e-9);
+    CHECK_EQUAL(9999.0, delay[1]);
+    CHECK_EQUAL(9999.0, delay[2]);
+}
+
+TEST(testIonosphereInterpolator_Time)
+{
+    bnav::IonosphereInterpolator interpolator(360);
+    interpolator.addIonosphere(lcl_getLinearGrid(360, 100));
+    interpolator.addIonosphere(lcl_getLinearGrid(0, 0));
+    // gap of two grids
+    interpolator.addIonosphere(lcl_getLinearGrid(1080, 200));
+
+    const double t0 { bnav::IonosphereInterpolator::getTime(bnav::DateTime(bnav::TimeSystem::BDT, 452, 0)) };
+    const std::vector<double> time { t0 - 1.0, t0 + 90.0, t0 + 360.0, t0 + 180.0, t0 + 720.0, t0 + 1080.0, t0 + 1081.0 };
+    const std::vector<double> lat(time.size(), 55.0);
+    const std::vector<double> lon(time.size(), 75.0);
+
+    std::vector<double> delay;
+    CHECK_EQUAL(4, interpolator.evaluate(lat, lon, time, delay));
+    CHECK_EQUAL(9999.0, delay[0]);
+    CHECK_CLOSE(26.0, delay[1], 1e-9);
+    CHECK_CLOSE(101.0, delay[2], 1e-9);
+    CHECK_CLOSE(51.0, delay[3], 1e-9);
+    CHECK_EQUAL(9999.0, delay[4]);
+    CHECK_CLOSE(201.0, delay[5], 1e-9);
+    CHECK_EQUAL(9999.0, delay[6]);
+}
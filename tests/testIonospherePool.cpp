@@ -0,0 +1,109 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "IonospherePool.h"
+
+#include "AsciiReader.h"
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "Ionosphere.h"
+#include "IonosphereStore.h"
+#include "Subframe.h"
+#include "SubframeBuffer.h"
+#include "SvID.h"
+
+#include <utility>
+
+TEST(testIonospherePool_AcquireRelease)
+{
+    const bnav::KlobucharParam klob { bnavtest::getKlobucharParam() };
+    const bnav::DateTime dt(bnav::TimeSystem::BDT, 452, 7200);
+
+    bnav::IonospherePool pool;
+    CHECK_EQUAL(0, pool.getFreeCount());
+
+    // empty pool gives an empty model
+    bnav::Ionosphere iono { pool.acquire() };
+    CHECK(!iono.hasData());
+
+    iono.load(klob, dt);
+    CHECK(iono.hasData());
+    pool.release(std::move(iono));
+    CHECK_EQUAL(1, pool.getFreeCount());
+
+    // a recycled regional model loaded with a global grid, and back
+    bnav::Ionosphere recycled { pool.acquire() };
+    CHECK_EQUAL(0, pool.getFreeCount());
+
+    recycled.load(klob, dt, true);
+    CHECK_EQUAL(5183, recycled.getGrid().size());
+    CHECK(recycled == bnav::Ionosphere(klob, dt, true));
+
+    recycled.load(klob, dt);
+    CHECK_EQUAL(320, recycled.getGrid().size());
+    CHECK(recycled == bnav::Ionosphere(klob, dt));
+}
+
+TEST(testIonospherePool_StoreRecycle)
+{
+    const bnav::KlobucharParam klob { bnavtest::getKlobucharParam() };
+    const bnav::SvID sv(2);
+
+    bnav::IonosphereStore store;
+    store.addIonosphere(sv, bnav::Ionosphere(klob, bnav::DateTime(bnav::TimeSystem::BDT, 452, 0)));
+    store.addIonosphere(sv, bnav::Ionosphere(klob, bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200)));
+    CHECK(store.hasDataForSv(sv));
+
+    // both refer to the models in the store
+    const auto items = store.getItemsBySv(sv);
+    const auto iono = store.getIonosphere(sv, bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200));
+    CHECK(items && iono);
+    CHECK_EQUAL(2, items->size());
+    CHECK(&items->back() == &iono.get());
+    CHECK(!store.getIonosphere(sv, bnav::DateTime(bnav::TimeSystem::BDT, 452, 3600)));
+
+    bnav::IonospherePool pool;
+    // unknown SV is ignored
+    store.recycle(bnav::SvID(3), pool);
+    CHECK_EQUAL(0, pool.getFreeCount());
+
+    store.recycle(sv, pool);
+    CHECK(!store.hasDataForSv(sv));
+    CHECK_EQUAL(2, pool.getFreeCount());
+}
+
+TEST(testIonospherePool_RecycleRegionalGrid)
+{
+    bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                             bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+    bnav::SubframeBufferD2 sfbuf(bnav::D2AlmanacPages::IONOSPHERE);
+    bnav::IonospherePool pool;
+    pool.release(bnav::Ionosphere(bnavtest::getKlobucharParam(), bnav::DateTime(bnav::TimeSystem::BDT, 452, 0)));
+
+    std::size_t gridcount = 0;
+    bnav::AsciiReaderEntry entry;
+    while (reader.readLine(entry))
+    {
+        if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+            continue;
+
+        sfbuf.addSubframe(bnav::Subframe(bnav::SvID(entry.getPRN()), entry.getBits()));
+        if (!sfbuf.isAlmanacComplete())
+            continue;
+
+        const bnav::SubframeBufferParam data = sfbuf.flushAlmanacData();
+
+        // the recycled model carries the date of the Klobuchar model
+        bnav::Ionosphere recycled { pool.acquire() };
+        recycled.load(data, 452);
+
+        const bnav::Ionosphere fresh(data, 452);
+        CHECK(recycled == fresh);
+        CHECK(recycled.getDateOfIssue() == fresh.getDateOfIssue());
+        pool.release(std::move(recycled));
+        ++gridcount;
+    }
+    CHECK_EQUAL(1, gridcount);
+}
@@ -0,0 +1,179 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "IonosphereSnapshot.h"
+
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "Ionosphere.h"
+#include "IonosphereGrid.h"
+#include "IonosphereGridInfo.h"
+#include "IonosphereStore.h"
+#include "SvID.h"
+
+#include <bitset>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+bnav::KlobucharParam lcl_getKlobucharParam()
+{
+    bnav::KlobucharParam klob { bnavtest::getKlobucharParam() };
+    klob.rawbits = bnav::NavBits<64>(std::bitset<64>(0x123456789ABCDEFULL));
+    return klob;
+}
+
+// regional grid with a few unavailable IGPs
+bnav::Ionosphere lcl_getRegionalGrid(const uint32_t sow)
+{
+    std::vector<bnav::IonoGridInfo> grid;
+    for (uint32_t i = 0; i < 320; ++i)
+        grid.push_back(i % 7 == 0 ? bnav::IonoGridInfo(9999, 9999) : bnav::IonoGridInfo(i + sow / 360, i % 16));
+
+    bnav::Ionosphere iono;
+    iono.setGridDimension(bnav::IonoGridDimension(55.0, 7.5, -2.5, 70.0, 145.0, 5.0));
+    iono.setGrid(grid);
+    iono.setDateOfIssue(bnav::DateTime(bnav::TimeSystem::BDT, 452, sow));
+    return iono;
+}
+
+void lcl_checkEqual(const bnav::IonosphereStore &expected, const bnav::IonosphereStore &actual)
+{
+    CHECK(expected.getSvList() == actual.getSvList());
+    for (const bnav::SvID &sv : expected.getSvList())
+    {
+        const bnav::TimeSeries<bnav::Ionosphere> &items = *expected.getItemsBySv(sv);
+        const bnav::TimeSeries<bnav::Ionosphere> &restored = *actual.getItemsBySv(sv);
+        CHECK_EQUAL(items.size(), restored.size());
+        for (std::size_t i = 0; i < items.size() && i < restored.size(); ++i)
+        {
+            CHECK(items[i].getDateOfIssue() == restored[i].getDateOfIssue());
+            CHECK(items[i].getGrid() == restored[i].getGrid());
+            CHECK_EQUAL(items[i].getGridDimension().getItemCountLongitude(), restored[i].getGridDimension().getItemCountLongitude());
+            CHECK_EQUAL(items[i].getGridDimension().latitude_north, restored[i].getGridDimension().latitude_north);
+            CHECK_EQUAL(!!items[i].getKlobucharParam(), !!restored[i].getKlobucharParam());
+            if (items[i].getKlobucharParam() && restored[i].getKlobucharParam())
+            {
+                CHECK(*items[i].getKlobucharParam() == *restored[i].getKlobucharParam());
+                CHECK_EQUAL(items[i].getKlobucharParam()->beta3, restored[i].getKlobucharParam()->beta3);
+            }
+        }
+    }
+}
+
+}
+
+TEST(testIonosphereSnapshot_WriteRead)
+{
+    bnav::IonosphereStore regional;
+    regional.addIonosphere(bnav::SvID(1), lcl_getRegionalGrid(0));
+    regional.addIonosphere(bnav::SvID(1), lcl_getRegionalGrid(360));
+    regional.addIonosphere(bnav::SvID(4), lcl_getRegionalGrid(720));
+
+    bnav::IonosphereStore klobuchar;
+    klobuchar.addIonosphere(bnav::SvID(2), bnav::Ionosphere(lcl_getKlobucharParam(), bnav::DateTime(bnav::TimeSystem::BDT, 452, 0)));
+    klobuchar.addIonosphere(bnav::SvID(2), bnav::Ionosphere(lcl_getKlobucharParam(), bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200), true));
+
+    const std::string filename[] = { "testIonosphereSnapshot-regional.snap", "testIonosphereSnapshot-klobuchar.snap" };
+    const bnav::IonosphereStore *stores[] = { &regional, &klobuchar };
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        CHECK(bnav::IonosphereSnapshot::write(filename[i], *stores[i]));
+
+        bnav::IonosphereStore restored;
+        CHECK(bnav::IonosphereSnapshot::read(filename[i], restored));
+        lcl_checkEqual(*stores[i], restored);
+
+        std::remove(filename[i].c_str());
+    }
+
+    // header, models and cells padded to 8 bytes
+    CHECK_EQUAL(8, bnav::IonosphereSnapshot::getCellBytes(1));
+    CHECK_EQUAL(1280, bnav::IonosphereSnapshot::getCellBytes(320));
+    CHECK_EQUAL(20736, bnav::IonosphereSnapshot::getCellBytes(5183));
+}
+
+TEST(testIonosphereSnapshot_Malformed)
+{
+    bnav::IonosphereStore regional;
+    regional.addIonosphere(bnav::SvID(1), lcl_getRegionalGrid(0));
+    regional.addIonosphere(bnav::SvID(1), lcl_getRegionalGrid(360));
+
+    const std::string filename { "testIonosphereSnapshot-malformed.snap" };
+    CHECK(bnav::IonosphereSnapshot::write(filename, regional));
+
+    std::vector<char> content;
+    {
+        std::ifstream infile(filename, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+    }
+    CHECK_EQUAL(sizeof(bnav::IonosphereSnapshot::FileHeader) + 2 * (sizeof(bnav::IonosphereSnapshot::ModelHeader) + 1280), content.size());
+
+    // truncated within the last model, the store is not changed
+    {
+        std::ofstream outfile(filename, std::ios::binary | std::ios::trunc);
+        outfile.write(content.data(), static_cast<std::streamsize>(content.size()) - 8);
+    }
+    bnav::IonosphereStore restored;
+    CHECK(!bnav::IonosphereSnapshot::read(filename, restored));
+    CHECK(!restored.hasDataForSv(bnav::SvID(1)));
+
+    // PRN of the second model out of range
+    content[sizeof(bnav::IonosphereSnapshot::FileHeader) + sizeof(bnav::IonosphereSnapshot::ModelHeader) + 1280] = 99;
+    {
+        std::ofstream outfile(filename, std::ios::binary | std::ios::trunc);
+        outfile.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    CHECK(!bnav::IonosphereSnapshot::read(filename, restored));
+    CHECK(!restored.hasDataForSv(bnav::SvID(1)));
+
+    std::remove(filename.c_str());
+    CHECK(!bnav::IonosphereSnapshot::read(filename, restored));
+}
+
+// Klobuchar maps at any spacing are written, grids not matching their
+// dimension are refused
+TEST(testIonosphereSnapshot_GridSpacing)
+{
+    const bnav::IonoGridDimension dim { bnav::getKlobucharGridDimension(true, 1.0, 2.0) };
+    const std::size_t cellcount { dim.getItemCountLatitude() * dim.getItemCountLongitude() };
+    CHECK_EQUAL(176 * 181, cellcount);
+
+    bnav::Ionosphere iono;
+    iono.setGridDimension(dim);
+    iono.setGrid(bnav::IonoGrid(cellcount, bnav::IonoGridInfo(42, 3)));
+    iono.setDateOfIssue(bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200));
+    iono.setKlobucharParam(lcl_getKlobucharParam());
+
+    bnav::IonosphereStore klobuchar;
+    klobuchar.addIonosphere(bnav::SvID(2), iono);
+
+    const std::string filename { "testIonosphereSnapshot-spacing.snap" };
+    CHECK(bnav::IonosphereSnapshot::write(filename, klobuchar));
+
+    bnav::IonosphereStore restored;
+    CHECK(bnav::IonosphereSnapshot::read(filename, restored));
+    lcl_checkEqual(klobuchar, restored);
+
+    // a regional grid in a coarser global dimension, an existing snapshot is
+    // kept
+    bnav::Ionosphere mismatch;
+    mismatch.setGridDimension(bnav::getKlobucharGridDimension(true, 10.0, 10.0));
+    mismatch.setGrid(bnav::IonoGrid(320, bnav::IonoGridInfo(42, 3)));
+    mismatch.setDateOfIssue(bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200));
+    klobuchar.addIonosphere(bnav::SvID(3), mismatch);
+    CHECK(!bnav::IonosphereSnapshot::write(filename, klobuchar));
+
+    bnav::IonosphereStore kept;
+    CHECK(bnav::IonosphereSnapshot::read(filename, kept));
+    CHECK(kept.hasDataForSv(bnav::SvID(2)));
+    CHECK(!kept.hasDataForSv(bnav::SvID(3)));
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,73 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "IonosphereStore.h"
+
+#include "BeiDou.h"
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "Ionosphere.h"
+#include "IonospherePool.h"
+#include "SvID.h"
+
+#include <vector>
+
+TEST(testIonosphereStore_RetentionCount)
+{
+    const bnav::KlobucharParam klob { bnavtest::getKlobucharParam() };
+    bnav::IonosphereStore store;
+    store.setRetention(2, 0);
+    store.setQueueEvicted(true);
+
+    for (uint32_t i = 0; i < 4; ++i)
+        store.addIonosphere(bnav::SvID(2), bnav::Ionosphere(klob, bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200 * i)));
+    store.addIonosphere(bnav::SvID(3), bnav::Ionosphere(klob, bnav::DateTime(bnav::TimeSystem::BDT, 452, 0)));
+
+    // oldest models first, others are not affected
+    bnav::IonosphereStore::EvictedModels evicted;
+    store.takeEvicted(evicted);
+    CHECK_EQUAL(2, evicted.size());
+    CHECK_EQUAL(2, evicted[0].first.getPRN());
+    CHECK_EQUAL(0, evicted[0].second.getDateOfIssue().getSOW());
+    CHECK_EQUAL(7200, evicted[1].second.getDateOfIssue().getSOW());
+    CHECK_EQUAL(2, store.getEvictedCount());
+    CHECK_EQUAL(2, store.getItemsBySv(bnav::SvID(2))->size());
+    CHECK_EQUAL(14400, store.getItemsBySv(bnav::SvID(2))->front().getDateOfIssue().getSOW());
+    CHECK(store.hasDataForSv(bnav::SvID(3)));
+
+    // taken models are recycled
+    bnav::IonospherePool pool;
+    for (auto &model : evicted)
+        pool.release(std::move(model.second));
+    CHECK_EQUAL(2, pool.getFreeCount());
+
+    // a model older than all kept ones is evicted at once
+    store.addIonosphere(bnav::SvID(2), bnav::Ionosphere(klob, bnav::DateTime(bnav::TimeSystem::BDT, 452, 3600)));
+    store.takeEvicted(evicted);
+    CHECK_EQUAL(1, evicted.size());
+    CHECK_EQUAL(3600, evicted.back().second.getDateOfIssue().getSOW());
+    CHECK_EQUAL(2, store.getItemsBySv(bnav::SvID(2))->size());
+}
+
+TEST(testIonosphereStore_RetentionAge)
+{
+    const bnav::KlobucharParam klob { bnavtest::getKlobucharParam() };
+    bnav::IonosphereStore store;
+    // one day, without queue the models are dropped
+    store.setRetention(0, 86400);
+
+    // across a week change
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        const uint32_t sec { bnav::SECONDS_OF_A_WEEK - 86400 + 7200 * i };
+        store.addIonosphere(bnav::SvID(1), bnav::Ionosphere(klob, bnav::DateTime(bnav::TimeSystem::BDT, 452 + sec / bnav::SECONDS_OF_A_WEEK, sec % bnav::SECONDS_OF_A_WEEK)));
+    }
+
+    // models of the last day, the first at the day boundary is kept
+    const auto items = store.getItemsBySv(bnav::SvID(1));
+    CHECK_EQUAL(13, items->size());
+    CHECK_EQUAL(7, store.getEvictedCount());
+    CHECK(items->front().getDateOfIssue() == bnav::DateTime(bnav::TimeSystem::BDT, 452, bnav::SECONDS_OF_A_WEEK - 86400 + 7 * 7200));
+    CHECK(items->back().getDateOfIssue() == bnav::DateTime(bnav::TimeSystem::BDT, 453, 19 * 7200 - 86400));
+}
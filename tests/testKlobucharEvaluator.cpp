@@ -0,0 +1,78 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "KlobucharEvaluator.h"
+
+#include "Ephemeris.h"
+#include "Ionosphere.h"
+#include "IonosphereGrid.h"
+#include "IonosphereGridInfo.h"
+
+#include <vector>
+
+namespace
+{
+
+// grid cell by cell with the scalar model
+void lcl_checkGrid(const bnav::KlobucharParam &klob, const bnav::IonoGridDimension &dim, const uint32_t time)
+{
+    bnav::KlobucharEvaluator evaluator(klob);
+    bnav::IonoGrid grid;
+    evaluator.evaluate(dim, time, grid);
+
+    const std::size_t rowcount = dim.getItemCountLatitude();
+    const std::size_t colcount = dim.getItemCountLongitude();
+    CHECK_EQUAL(rowcount * colcount, grid.size());
+
+    for (std::size_t row = 0; row < rowcount; ++row)
+    {
+        for (std::size_t col = 0; col < colcount; ++col)
+        {
+            const double phi { dim.latitude_north + static_cast<double>(row) * dim.latitude_spacing };
+            const double lambda { dim.longitude_west + static_cast<double>(col) * dim.longitude_spacing };
+            bnav::IonoGridInfo info;
+            info.loadFromMeter(evaluator.getVerticalDelay(time, phi, lambda));
+            CHECK(grid[row * colcount + col] == info);
+        }
+    }
+}
+
+}
+
+TEST(testKlobucharEvaluator_Scalar)
+{
+    const bnav::KlobucharEvaluator evaluator(bnavtest::getKlobucharParam());
+
+    // night time delay only
+    CHECK_CLOSE(5.0e-9 * 2.99792458e8, evaluator.getVerticalDelay(0, 30.0, 0.0), 1e-9);
+
+    // 14h local time at 90 degrees east
+    CHECK(evaluator.getVerticalDelay(28800, 30.0, 90.0) > evaluator.getVerticalDelay(0, 30.0, 90.0));
+}
+
+TEST(testKlobucharEvaluator_Grid)
+{
+    const bnav::KlobucharParam klob { bnavtest::getKlobucharParam() };
+    const bnav::IonoGridDimension regional(55.0, 7.5, -2.5, 70.0, 145.0, 5.0);
+    const bnav::IonoGridDimension global(87.5, -87.5, -2.5, -180.0, 180.0, 5.0);
+
+    for (uint32_t time = 0; time < 86400; time += 7200)
+    {
+        lcl_checkGrid(klob, regional, time);
+        lcl_checkGrid(klob, global, time);
+    }
+
+    // both hemispheres are equal
+    bnav::KlobucharEvaluator evaluator(klob);
+    bnav::IonoGrid grid;
+    evaluator.evaluate(global, 28800, grid);
+    CHECK_EQUAL(5183, grid.size());
+    for (std::size_t col = 0; col < 73; ++col)
+        CHECK(grid[col] == grid[70 * 73 + col]);
+
+    // storage is reused, same as Ionosphere
+    evaluator.evaluate(regional, 28800, grid);
+    CHECK_EQUAL(320, grid.size());
+    CHECK(bnav::Ionosphere(klob, bnav::DateTime(bnav::TimeSystem::BDT, 452, 28800)).getGrid() == grid);
+}
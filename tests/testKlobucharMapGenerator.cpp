@@ -0,0 +1,104 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "KlobucharMapGenerator.h"
+
+#include "BeiDou.h"
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "IonexWriter.h"
+#include "Ionosphere.h"
+#include "TimeSeriesStore.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+void lcl_addModel(bnav::TimeSeries<bnav::Ionosphere> &models, const uint32_t sow, const double alpha0)
+{
+    const bnav::DateTime dt(bnav::TimeSystem::BDT, 452, sow);
+    models.insert(dt, bnav::Ionosphere(bnavtest::getKlobucharParam(alpha0), dt));
+}
+
+// file content without the line of the creation date
+std::vector<std::string> lcl_readIonex(const std::string &filename)
+{
+    std::ifstream infile(filename);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(infile, line))
+        if (line.find("PGM / RUN BY / DATE") == std::string::npos)
+            lines.push_back(line);
+    return lines;
+}
+
+}
+
+TEST(testKlobucharMapGenerator_Epochs)
+{
+    bnav::TimeSeries<bnav::Ionosphere> models;
+    lcl_addModel(models, 0, 1.0e-08);
+    lcl_addModel(models, 7200, 2.0e-08);
+    // gap of two update intervals
+    lcl_addModel(models, 21600, 3.0e-08);
+
+    const bnav::KlobucharMapGenerator generator(bnav::getKlobucharGridDimension(false), 1800, bnav::KLOBUCHAR_UPDATE_INTERVAL);
+    const boost::posix_time::ptime until { bnav::DateTime(bnav::TimeSystem::BDT, 452, 25200).get_ptime() };
+    const std::vector<bnav::KlobucharMapGenerator::Epoch> epochs { generator.getEpochs(models, until) };
+
+    // four epochs for each of the first two models, the last one is cut
+    CHECK_EQUAL(11, epochs.size());
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        CHECK(epochs[i].datetime == bnav::DateTime(bnav::TimeSystem::BDT, 452, 1800 * i));
+        CHECK_EQUAL(i < 4 ? 1.0e-08 : 2.0e-08, epochs[i].param.alpha0);
+    }
+    CHECK(epochs[8].datetime == bnav::DateTime(bnav::TimeSystem::BDT, 452, 21600));
+    CHECK(epochs[10].datetime == bnav::DateTime(bnav::TimeSystem::BDT, 452, 25200));
+    CHECK_EQUAL(3.0e-08, epochs[10].param.alpha0);
+
+    // interval above the validity gives one epoch for each model
+    const bnav::KlobucharMapGenerator sparse(bnav::getKlobucharGridDimension(false), 14400, bnav::KLOBUCHAR_UPDATE_INTERVAL);
+    CHECK_EQUAL(3, sparse.getEpochs(models, until).size());
+}
+
+TEST(testKlobucharMapGenerator_Write)
+{
+    bnav::TimeSeries<bnav::Ionosphere> models;
+    lcl_addModel(models, 0, 1.0e-08);
+    lcl_addModel(models, 7200, 2.0e-08);
+
+    const bnav::IonoGridDimension dim { bnav::getKlobucharGridDimension(true, 0.5, 0.5) };
+    CHECK_EQUAL(351, dim.getItemCountLatitude());
+    CHECK_EQUAL(721, dim.getItemCountLongitude());
+
+    const boost::posix_time::ptime until { bnav::DateTime(bnav::TimeSystem::BDT, 452, 86400).get_ptime() };
+
+    // the maps are the same, no matter how many are evaluated at once
+    const std::string filename[] = { "testKlobucharMapGenerator-1.inx", "testKlobucharMapGenerator-3.inx" };
+    const std::size_t threadcount[] = { 1, 3 };
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        bnav::IonexWriter writer(filename[i], 1800, true);
+        CHECK(writer.isOpen());
+        const bnav::KlobucharMapGenerator generator(dim, 1800, bnav::KLOBUCHAR_UPDATE_INTERVAL, threadcount[i]);
+        CHECK(generator.write(models, until, writer));
+        writer.close();
+    }
+
+    const std::vector<std::string> single { lcl_readIonex(filename[0]) };
+    CHECK(single == lcl_readIonex(filename[1]));
+    std::size_t mapcount = 0;
+    for (const std::string &line : single)
+        if (line.find("START OF TEC MAP") != std::string::npos)
+            ++mapcount;
+    CHECK_EQUAL(8, mapcount);
+
+    std::remove(filename[0].c_str());
+    std::remove(filename[1].c_str());
+}
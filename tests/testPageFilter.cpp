@@ -0,0 +1,155 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+
+#include "PageFilter.h"
+#include "Subframe.h"
+#include "SubframeBuffer.h"
+
+#include "AsciiReader.h"
+#include "BeiDou.h"
+#include "SvID.h"
+
+#include <iostream>
+
+TEST(testPageFilter_Products)
+{
+    bnav::PageFilter filter;
+    CHECK(!filter.isProductEnabled(bnav::Product::KLOBUCHAR));
+    CHECK(!filter.isProductEnabled(bnav::Product::REGIONAL_GRID));
+
+    filter.enableProduct(bnav::Product::REGIONAL_GRID);
+    CHECK(!filter.isProductEnabled(bnav::Product::KLOBUCHAR));
+    CHECK(filter.isProductEnabled(bnav::Product::REGIONAL_GRID));
+
+    filter.enableProduct(bnav::Product::KLOBUCHAR);
+    CHECK(filter.isProductEnabled(bnav::Product::KLOBUCHAR));
+    CHECK(filter.isProductEnabled(bnav::Product::REGIONAL_GRID));
+}
+
+// Test real data
+SUITE(testPageFilter_SBF_Superframe)
+{
+    TEST(testPageFilter_SuperframeD1)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::PageFilter filternone;
+        bnav::PageFilter filterregional;
+        filterregional.enableProduct(bnav::Product::REGIONAL_GRID);
+        bnav::PageFilter filterklob;
+        filterklob.enableProduct(bnav::Product::KLOBUCHAR);
+
+        std::size_t msgcount = 0, klobcount = 0;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf;
+            sf.setSvID(sv);
+            sf.setBits(entry.getBits());
+            sf.initializeHeader();
+
+            CHECK(!filternone.isRequired(sv, sf));
+            // the regional grid is not broadcast by D1 satellites
+            CHECK(!filterregional.isRequired(sv, sf));
+            if (filterklob.isRequired(sv, sf))
+            {
+                CHECK_EQUAL(1, sf.getFrameID());
+                ++klobcount;
+            }
+            ++msgcount;
+        }
+        CHECK_EQUAL(150, msgcount);
+        // only subframe 1 of each frame
+        CHECK_EQUAL(30, klobcount);
+        reader.close();
+    }
+
+    // filtered pages have to give the same data sets as unfiltered ones
+    TEST(testPageFilter_SuperframeD2)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::PageFilter filterklob;
+        filterklob.enableProduct(bnav::Product::KLOBUCHAR);
+        bnav::PageFilter filterall;
+        filterall.enableProduct(bnav::Product::KLOBUCHAR);
+        filterall.enableProduct(bnav::Product::REGIONAL_GRID);
+
+        bnav::SubframeBufferD2 sfbuf(bnav::D2AlmanacPages::IONOSPHERE, bnav::EphemerisPages::KLOBUCHAR);
+        bnav::SubframeBufferD2 sfbuffiltered(bnav::D2AlmanacPages::IONOSPHERE, bnav::EphemerisPages::KLOBUCHAR);
+
+        std::size_t msgcount = 0, klobcount = 0, allcount = 0;
+        std::size_t ephcount = 0, almcount = 0, ephfilteredcount = 0, almfilteredcount = 0;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sfheader;
+            sfheader.setSvID(sv);
+            sfheader.setBits(entry.getBits());
+            sfheader.initializeHeader();
+
+            // header only decoding gives the same header
+            const bnav::Subframe sf(sv, entry.getBits());
+            CHECK_EQUAL(sf.getFrameID(), sfheader.getFrameID());
+            CHECK_EQUAL(sf.getPageNum(), sfheader.getPageNum());
+            CHECK_EQUAL(sf.getSOW(), sfheader.getSOW());
+            ++msgcount;
+
+            if (filterklob.isRequired(sv, sfheader))
+            {
+                CHECK_EQUAL(1, sfheader.getFrameID());
+                ++klobcount;
+            }
+
+            sfbuf.addSubframe(sf);
+            if (sfbuf.isEphemerisComplete())
+            {
+                sfbuf.flushEphemerisData();
+                ++ephcount;
+            }
+            else if (sfbuf.isAlmanacComplete())
+            {
+                sfbuf.flushAlmanacData();
+                ++almcount;
+            }
+
+            if (!filterall.isRequired(sv, sfheader))
+                continue;
+
+            ++allcount;
+            sfheader.initializeData();
+            CHECK(sf.getBits() == sfheader.getBits());
+
+            sfbuffiltered.addSubframe(sfheader);
+            if (sfbuffiltered.isEphemerisComplete())
+            {
+                sfbuffiltered.flushEphemerisData();
+                ++ephfilteredcount;
+            }
+            else if (sfbuffiltered.isAlmanacComplete())
+            {
+                sfbuffiltered.flushAlmanacData();
+                ++almfilteredcount;
+            }
+        }
+        CHECK_EQUAL(750, msgcount);
+        // 150 frames: pages 1 and 2 of frame 1, 15 times
+        CHECK_EQUAL(30, klobcount);
+        // and both IGP blocks of frame 5, the first one twice
+        CHECK_EQUAL(30 + 3 * 13, allcount);
+        CHECK_EQUAL(ephcount, ephfilteredcount);
+        CHECK_EQUAL(almcount, almfilteredcount);
+        CHECK_EQUAL(1, almfilteredcount);
+        reader.close();
+    }
+}
@@ -0,0 +1,189 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "PageVoter.h"
+#include "Subframe.h"
+
+#include "AsciiReader.h"
+#include "BeiDou.h"
+#include "NavBits.h"
+#include "SvID.h"
+
+#include <vector>
+
+namespace
+{
+
+// two bits in one subword of word 4 are turned into a wrong correction
+bnav::Subframe lcl_breakSubframe(const bnav::SvID &sv, const bnav::Subframe &sf,
+                                 const std::size_t first = 95, const std::size_t second = 96)
+{
+    bnav::NavBits<300> bits { sf.getBits() };
+    bits.flipLeft(first);
+    bits.flipLeft(second);
+    return bnav::Subframe(sv, bits);
+}
+
+}
+
+SUITE(testPageVoter_SBF_Superframe)
+{
+    // a double error is voted away by two clean copies
+    TEST(testPageVoter_RepairDoubleError)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt") };
+        const bnav::SvID sv(6);
+        const bnav::Subframe &sfref = subframes[0];
+        CHECK_EQUAL(0, sfref.getParityModifiedCount());
+
+        bnav::Subframe sfbroken { lcl_breakSubframe(sv, sfref) };
+        CHECK(sfbroken.getParityModifiedCount() != 0);
+        CHECK(!(sfbroken.getBits() == sfref.getBits()));
+
+        bnav::PageVoter voter;
+        bnav::Subframe copy { sfref };
+        voter.repair(sv, copy);
+        copy = sfref;
+        voter.repair(sv, copy);
+        CHECK(copy.getBits() == sfref.getBits());
+        CHECK_EQUAL(0, voter.getVotedWordCount());
+
+        voter.repair(sv, sfbroken);
+        CHECK(sfbroken.getBits() == sfref.getBits());
+        CHECK_EQUAL(0, sfbroken.getParityModifiedCount());
+        CHECK_EQUAL(1, voter.getVotedWordCount());
+        CHECK_EQUAL(1, voter.getRepairedWordCount());
+    }
+
+    // a single copy is no majority
+    TEST(testPageVoter_NoMajority)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt") };
+        const bnav::SvID sv(6);
+        const bnav::Subframe &sfref = subframes[0];
+
+        const bnav::Subframe sfbroken { lcl_breakSubframe(sv, sfref) };
+        bnav::Subframe sfvoted { sfbroken };
+
+        bnav::PageVoter voter;
+        bnav::Subframe copy { sfref };
+        voter.repair(sv, copy);
+        voter.repair(sv, sfvoted);
+
+        CHECK(sfvoted.getBits() == sfbroken.getBits());
+        CHECK_EQUAL(0, voter.getVotedWordCount());
+    }
+
+    // copies of other data don't vote
+    TEST(testPageVoter_OtherData)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt") };
+        const bnav::SvID sv(6);
+        const bnav::Subframe &sfref = subframes[0];
+
+        // clean word 6 of another subframe
+        bnav::Subframe sfother { sfref };
+        sfother.replaceWord(5, subframes[1].getBits());
+        CHECK_EQUAL(0, sfother.getParityModifiedCount());
+        CHECK(!(sfother.getBits() == sfref.getBits()));
+
+        const bnav::Subframe sfbroken { lcl_breakSubframe(sv, sfref) };
+        bnav::Subframe sfvoted { sfbroken };
+
+        // keep only the last two copies
+        bnav::PageVoter voter(2);
+        bnav::Subframe copy { sfother };
+        voter.repair(sv, copy);
+        copy = sfother;
+        voter.repair(sv, copy);
+        voter.repair(sv, sfvoted);
+
+        CHECK(sfvoted.getBits() == sfbroken.getBits());
+        CHECK_EQUAL(0, voter.getVotedWordCount());
+
+        // copies of the same data still vote
+        copy = sfref;
+        voter.repair(sv, copy);
+        copy = sfref;
+        voter.repair(sv, copy);
+        sfvoted = sfbroken;
+        voter.repair(sv, sfvoted);
+        CHECK(sfvoted.getBits() == sfref.getBits());
+    }
+
+    // the first copy of new data has a wrong correction in the changed word,
+    // copies of the last update interval don't vote
+    TEST(testPageVoter_DataChange)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt") };
+        const bnav::SvID sv(6);
+        const bnav::Subframe &sfold = subframes[0];
+
+        // same page one frame later, the next hour and word 4 changed
+        bnav::NavBits<300> bits { sfold.getBits() };
+        for (std::size_t i = 0; i < 60; ++i)
+            bits.setLeft(i, subframes[5].getBits().atLeft(i));
+        for (std::size_t i = 90; i < 120; ++i)
+            bits.setLeft(i, subframes[1].getBits().atLeft(i));
+        const bnav::Subframe sfnew(sv, bits);
+        CHECK_EQUAL(0, sfnew.getParityModifiedCount());
+        CHECK_EQUAL(sfold.getFrameID(), sfnew.getFrameID());
+        CHECK(sfold.getSOW() / bnav::EPHEMERIS_UPDATE_INTERVAL != sfnew.getSOW() / bnav::EPHEMERIS_UPDATE_INTERVAL);
+        CHECK(!(sfold.getBits() == sfnew.getBits()));
+
+        const bnav::Subframe sfbroken { lcl_breakSubframe(sv, sfnew) };
+        CHECK_EQUAL(1, sfbroken.getParityModifiedCount());
+        bnav::Subframe sfvoted { sfbroken };
+
+        // keep only the last two copies
+        bnav::PageVoter voter(2);
+        bnav::Subframe copy { sfold };
+        voter.repair(sv, copy);
+        copy = sfold;
+        voter.repair(sv, copy);
+        voter.repair(sv, sfvoted);
+
+        CHECK(sfvoted.getBits() == sfbroken.getBits());
+        CHECK_EQUAL(0, voter.getVotedWordCount());
+
+        // copies of the new data vote
+        copy = sfnew;
+        voter.repair(sv, copy);
+        copy = sfnew;
+        voter.repair(sv, copy);
+        sfvoted = sfbroken;
+        voter.repair(sv, sfvoted);
+        CHECK(sfvoted.getBits() == sfnew.getBits());
+        CHECK_EQUAL(1, voter.getRepairedWordCount());
+    }
+
+    // copies with other wrong corrections give a majority, which is no BCH
+    // code word, the page keeps its word
+    TEST(testPageVoter_InvalidMajority)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt") };
+        const bnav::SvID sv(6);
+        const bnav::Subframe &sfref = subframes[0];
+
+        const bnav::Subframe sfbroken { lcl_breakSubframe(sv, sfref) };
+        bnav::Subframe sfvoted { sfbroken };
+
+        bnav::PageVoter voter;
+        bnav::Subframe copy { lcl_breakSubframe(sv, sfref, 95, 97) };
+        voter.repair(sv, copy);
+        copy = lcl_breakSubframe(sv, sfref, 96, 97);
+        voter.repair(sv, copy);
+        voter.repair(sv, sfvoted);
+
+        CHECK(sfvoted.getBits() == sfbroken.getBits());
+        CHECK_EQUAL(sfbroken.getParityModifiedCount(), sfvoted.getParityModifiedCount());
+        CHECK_EQUAL(1, voter.getVotedWordCount());
+        CHECK_EQUAL(0, voter.getRepairedWordCount());
+    }
+}
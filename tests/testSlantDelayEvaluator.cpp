@@ -0,0 +1,87 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "SlantDelayEvaluator.h"
+
+#include "BeiDou.h"
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "Ionosphere.h"
+#include "IonosphereInterpolator.h"
+#include "KlobucharEvaluator.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+// receiver at Wuhan, SV in zenith, north at 30 degrees and below the horizon
+bnav::LinesOfSight lcl_getLinesOfSight(const double time)
+{
+    bnav::LinesOfSight los;
+    los.latitude = { 30.5, 30.5, 30.5 };
+    los.longitude = { 114.0, 114.0, 114.0 };
+    los.azimuth = { 0.0, 0.0, 90.0 };
+    los.elevation = { 90.0, 30.0, -5.0 };
+    los.time = { time, time, time };
+    return los;
+}
+
+}
+
+TEST(testSlantDelayEvaluator_PiercePoint)
+{
+    const double time { bnav::IonosphereInterpolator::getTime(bnav::DateTime(bnav::TimeSystem::BDT, 452, 21600)) };
+    bnav::SlantDelayEvaluator evaluator;
+    std::vector<double> delay;
+    CHECK_EQUAL(2, evaluator.evaluate(bnavtest::getKlobucharParam(), lcl_getLinesOfSight(time), delay));
+
+    // zenith: pierce point above the receiver
+    CHECK_CLOSE(30.5, evaluator.getPierceLatitude()[0], 1e-9);
+    CHECK_CLOSE(114.0, evaluator.getPierceLongitude()[0], 1e-9);
+    CHECK_CLOSE(1.0, evaluator.getSlantFactor()[0], 1e-12);
+
+    // north: pierce point on the meridian, earth central angle to the north
+    const double ratio { 6378.0 / (6378.0 + 375.0) * std::cos(30.0 * bnav::PI / 180.0) };
+    const double psi { bnav::PI / 2.0 - 30.0 * bnav::PI / 180.0 - std::asin(ratio) };
+    CHECK_CLOSE(30.5 + psi * 180.0 / bnav::PI, evaluator.getPierceLatitude()[1], 1e-9);
+    CHECK_CLOSE(114.0, evaluator.getPierceLongitude()[1], 1e-9);
+    CHECK_CLOSE(1.0 / std::sqrt(1.0 - ratio * ratio), evaluator.getSlantFactor()[1], 1e-12);
+
+    CHECK_EQUAL(0.0, evaluator.getSlantFactor()[2]);
+    CHECK_EQUAL(9999.0, delay[2]);
+}
+
+TEST(testSlantDelayEvaluator_Klobuchar)
+{
+    const double time { bnav::IonosphereInterpolator::getTime(bnav::DateTime(bnav::TimeSystem::BDT, 452, 86400 + 21600)) };
+    bnav::SlantDelayEvaluator evaluator;
+    std::vector<double> delay;
+    evaluator.evaluate(bnavtest::getKlobucharParam(), lcl_getLinesOfSight(time), delay);
+
+    const bnav::KlobucharEvaluator klob(bnavtest::getKlobucharParam());
+    CHECK_CLOSE(klob.getVerticalDelay(21600, 30.5, 114.0), delay[0], 1e-12);
+    CHECK_CLOSE(evaluator.getSlantFactor()[1] * klob.getVerticalDelay(21600, evaluator.getPierceLatitude()[1], 114.0), delay[1], 1e-12);
+    CHECK(delay[1] > delay[0]);
+}
+
+TEST(testSlantDelayEvaluator_Grid)
+{
+    const bnav::DateTime dt(bnav::TimeSystem::BDT, 452, 21600);
+    bnav::IonosphereInterpolator interpolator;
+    interpolator.addIonosphere(bnav::Ionosphere(bnavtest::getKlobucharParam(), dt));
+
+    const bnav::LinesOfSight los { lcl_getLinesOfSight(bnav::IonosphereInterpolator::getTime(dt)) };
+    std::vector<double> vertical;
+    bnav::SlantDelayEvaluator evaluator;
+    std::vector<double> delay;
+    CHECK_EQUAL(2, evaluator.evaluate(interpolator, los, delay));
+    interpolator.evaluate(evaluator.getPierceLatitude(), evaluator.getPierceLongitude(), los.time, vertical);
+
+    // 0.1 TECU to meters on B1I
+    for (std::size_t i = 0; i < 2; ++i)
+        CHECK_CLOSE(evaluator.getSlantFactor()[i] * vertical[i] * 1.0e15 * 40.3 / (bnav::BDS_B1I_FREQ * bnav::BDS_B1I_FREQ), delay[i], 1e-9);
+    CHECK_EQUAL(9999.0, delay[2]);
+}
@@ -91,6 +91,42 @@ SUITE(testSubframe_SBF_Simple)
         reader.close();
     }
 
+    // same as testSubframeFraIDSimpleD1, but with the D1 header parser
+    TEST(testSubframe_SimpleD1_header)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA + "sbf/subframe/prn6-fraID.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        constexpr uint32_t sowlist[] = {345600, 345606, 345612, 345618, 345624};
+
+        std::size_t i = 0;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            const bnav::Subframe sfref(sv, entry.getBits());
+
+            // no SvID needed, type is given by the parser
+            bnav::Subframe sf;
+            sf.setBits(entry.getBits());
+            sf.initializeHeaderD1();
+
+            CHECK_EQUAL(i + 1, sf.getFrameID());
+            CHECK_EQUAL(sfref.getPageNum(), sf.getPageNum());
+            CHECK_EQUAL(sowlist[i], sf.getSOW());
+
+            sf.initializeData();
+            CHECK(sfref.getBits() == sf.getBits());
+
+            ++i;
+        }
+        CHECK_EQUAL(5, i);
+        reader.close();
+    }
+
     TEST(testSubframe_SimpleD2)
     {
         bnav::AsciiReader reader(PATH_TESTDATA + "sbf/subframe/prn2-fraID.txt",
@@ -1,6 +1,8 @@
 #include <UnitTest++/UnitTest++.h>
 #include "TestConfig.h"
 
+#include "Ephemeris.h"
+#include "Ionosphere.h"
 #include "Subframe.h"
 #include "SubframeBuffer.h"
 
@@ -10,6 +12,8 @@
 #include "SvID.h"
 
 #include <iostream>
+#include <map>
+#include <utility>
 
 // Test real data
 // Only for data sets from one single PRN
@@ -51,8 +55,10 @@ SUITE(testSubframeBuffer_SBF_Superframe_OnePRN)
             ++msgcount;
         }
         CHECK_EQUAL(150, msgcount);
-        // we should have completed 30 ephemeris data sets
-        CHECK_EQUAL(30, ephcount);
+        // we should have completed 29 ephemeris data sets, subframe 3 of the
+        // last frame is missing and the one before the first frame belongs
+        // to another frame
+        CHECK_EQUAL(29, ephcount);
         // and 1 almanac data set
         CHECK_EQUAL(1, almcount);
         CHECK_EQUAL(0, paritycount);
@@ -83,14 +89,22 @@ SUITE(testSubframeBuffer_SBF_Superframe_OnePRN)
             if (sfbuf.isEphemerisComplete())
             {
                 bnav::SubframeBufferParam data = sfbuf.flushEphemerisData();
-                (void) data; // avoid warnings
+                CHECK(data.type == bnav::SubframeBufferType::D2_EPHEMERIS);
+                CHECK_EQUAL(1, data.framecount);
+                CHECK_EQUAL(10, data.data[0].size());
                 ++ephcount;
             }
 
             else if (sfbuf.isAlmanacComplete())
             {
                 bnav::SubframeBufferParam data = sfbuf.flushAlmanacData();
-                (void) data; // avoid warnings
+                CHECK(data.type == bnav::SubframeBufferType::D2_ALMANAC);
+                CHECK_EQUAL(1, data.framecount);
+                // lent pages are in order and buffer is empty again
+                CHECK_EQUAL(120, data.data[0].size());
+                CHECK_EQUAL(1, data.data[0].front().getPageNum());
+                CHECK_EQUAL(120, data.data[0].back().getPageNum());
+                CHECK(!sfbuf.isAlmanacComplete());
                 ++almcount;
             }
 
@@ -147,3 +161,319 @@ SUITE(testSubframeBuffer_SBF_Superframe_OnePRN)
         reader.close();
     }
 }
+
+// Data with gaps and duplicates
+SUITE(testSubframeBuffer_SBF_Slots)
+{
+    // B1 and B2 carry the same message, every page arrives twice
+    TEST(testSubframeBuffer_DuplicatesD2)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::SubframeBufferD2 sfbuf;
+
+        std::size_t msgcount = 0, ephcount = 0, almcount = 0;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf(sv, entry.getBits());
+
+            sfbuf.addSubframe(sf);
+
+            if (sfbuf.isEphemerisComplete())
+            {
+                sfbuf.flushEphemerisData();
+                ++ephcount;
+            }
+
+            else if (sfbuf.isAlmanacComplete())
+            {
+                sfbuf.flushAlmanacData();
+                ++almcount;
+            }
+
+            ++msgcount;
+        }
+        CHECK_EQUAL(1500, msgcount);
+        // duplicates don't complete a data set twice
+        CHECK_EQUAL(14, ephcount);
+        CHECK_EQUAL(1, almcount);
+        reader.close();
+    }
+
+    // a lost page of frame 1 must not discard the almanac
+    TEST(testSubframeBuffer_GapD2)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::SubframeBufferD2 sfbuf;
+
+        std::size_t ephcount = 0, almcount = 0;
+        bool dropped = false;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf(sv, entry.getBits());
+
+            // drop the first page 5 of frame 1
+            if (!dropped && sf.getFrameID() == 1 && sf.getPageNum() == 5)
+            {
+                dropped = true;
+                continue;
+            }
+
+            sfbuf.addSubframe(sf);
+
+            if (sfbuf.isEphemerisComplete())
+            {
+                sfbuf.flushEphemerisData();
+                ++ephcount;
+            }
+
+            else if (sfbuf.isAlmanacComplete())
+            {
+                sfbuf.flushAlmanacData();
+                ++almcount;
+            }
+        }
+        CHECK(dropped);
+        CHECK_EQUAL(13, ephcount);
+        CHECK_EQUAL(1, almcount);
+        reader.close();
+    }
+}
+
+SUITE(testSubframeBuffer_SBF_IonospherePages)
+{
+    // collecting only the IGP blocks has to give the same grid earlier
+    TEST(testSubframeBuffer_IonospherePagesD2)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::SubframeBufferD2 sfbufall;
+        bnav::SubframeBufferD2 sfbufion(bnav::D2AlmanacPages::IONOSPHERE);
+
+        std::size_t msgcount = 0, ionmsgcount = 0, almmsgcount = 0;
+        bnav::Ionosphere ionall, ionpages;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf(sv, entry.getBits());
+            ++msgcount;
+
+            sfbufall.addSubframe(sf);
+            sfbufion.addSubframe(sf);
+
+            if (sfbufall.isAlmanacComplete())
+            {
+                bnav::SubframeBufferParam data = sfbufall.flushAlmanacData();
+                CHECK(data.type == bnav::SubframeBufferType::D2_ALMANAC);
+                ionall.load(data, 0);
+                almmsgcount = msgcount;
+            }
+
+            if (sfbufion.isAlmanacComplete())
+            {
+                bnav::SubframeBufferParam data = sfbufion.flushAlmanacData();
+                CHECK(data.type == bnav::SubframeBufferType::D2_IONOSPHERE);
+                CHECK_EQUAL(2, data.framecount);
+                CHECK_EQUAL(13, data.data[0].size());
+                CHECK_EQUAL(61, data.data[1].front().getPageNum());
+                ionpages.load(data, 0);
+                ionmsgcount = msgcount;
+            }
+        }
+        CHECK(ionall.hasData());
+        CHECK(ionpages.hasData());
+        CHECK(ionall == ionpages);
+        CHECK(ionall.getDateOfIssue() == ionpages.getDateOfIssue());
+
+        // complete after page 73, 47 frames before page 120
+        CHECK_EQUAL(47 * 5, almmsgcount - ionmsgcount);
+        reader.close();
+    }
+
+    // a page with a corrupted Pnum must not discard the grid
+    TEST(testSubframeBuffer_CorruptedPnumD2)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::SubframeBufferD2 sfbuf(bnav::D2AlmanacPages::IONOSPHERE);
+
+        std::size_t ioncount = 0;
+        bool corrupted = false;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf(sv, entry.getBits());
+
+            // a copy of page 7 of frame 5 claims to be page 10, its epoch is
+            // then nine seconds before the start of the superframe
+            if (!corrupted && sf.getFrameID() == 5 && sf.getPageNum() == 7)
+            {
+                bnav::Subframe sfcorrupted(sf);
+                sfcorrupted.setPageNum(10);
+                sfbuf.addSubframe(sfcorrupted);
+                corrupted = true;
+            }
+
+            sfbuf.addSubframe(sf);
+
+            if (sfbuf.isAlmanacComplete())
+            {
+                bnav::SubframeBufferParam data = sfbuf.flushAlmanacData();
+                CHECK(data.type == bnav::SubframeBufferType::D2_IONOSPHERE);
+                ++ioncount;
+            }
+        }
+        CHECK(corrupted);
+        CHECK_EQUAL(1, ioncount);
+        reader.close();
+    }
+}
+
+SUITE(testSubframeBuffer_SBF_KlobucharPages)
+{
+    // subframe 1 alone has to give the same Klobuchar parameters earlier
+    TEST(testSubframeBuffer_KlobucharPagesD1)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::SubframeBufferD1 sfbufall;
+        bnav::SubframeBufferD1 sfbufklob(bnav::EphemerisPages::KLOBUCHAR);
+
+        std::size_t msgcount = 0, ephcount = 0, klobcount = 0;
+        std::map<uint32_t, std::pair<bnav::Ephemeris, std::size_t> > klobsets;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf(sv, entry.getBits());
+            ++msgcount;
+
+            sfbufall.addSubframe(sf);
+            sfbufklob.addSubframe(sf);
+
+            if (sfbufklob.isEphemerisComplete())
+            {
+                bnav::SubframeBufferParam data = sfbufklob.flushEphemerisData();
+                CHECK(data.type == bnav::SubframeBufferType::D1_EPHEMERIS);
+                CHECK_EQUAL(1, data.framecount);
+                bnav::Ephemeris eph(data);
+                klobsets[eph.getSOW()] = std::make_pair(eph, msgcount);
+                ++klobcount;
+            }
+            else if (sfbufklob.isAlmanacComplete())
+            {
+                sfbufklob.flushAlmanacData();
+            }
+
+            if (sfbufall.isEphemerisComplete())
+            {
+                bnav::Ephemeris eph(sfbufall.flushEphemerisData());
+                auto it = klobsets.find(eph.getSOW());
+                CHECK(it != klobsets.end());
+                if (it != klobsets.end())
+                {
+                    CHECK(eph == it->second.first);
+                    CHECK_EQUAL(eph.getWeekNum(), it->second.first.getWeekNum());
+                    // complete two subframes earlier
+                    CHECK_EQUAL(2, msgcount - it->second.second);
+                }
+                ++ephcount;
+            }
+            else if (sfbufall.isAlmanacComplete())
+            {
+                sfbufall.flushAlmanacData();
+            }
+        }
+        CHECK_EQUAL(29, ephcount);
+        // subframe 1 of the last frame is there as well
+        CHECK_EQUAL(30, klobcount);
+        reader.close();
+    }
+
+    // pages 1 and 2 of frame 1 have to give the same Klobuchar parameters earlier
+    TEST(testSubframeBuffer_KlobucharPagesD2)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::SubframeBufferD2 sfbufall;
+        bnav::SubframeBufferD2 sfbufklob(bnav::D2AlmanacPages::ALL, bnav::EphemerisPages::KLOBUCHAR);
+
+        std::size_t msgcount = 0, ephcount = 0, klobcount = 0;
+        std::map<uint32_t, std::pair<bnav::Ephemeris, std::size_t> > klobsets;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf(sv, entry.getBits());
+            ++msgcount;
+
+            sfbufall.addSubframe(sf);
+            sfbufklob.addSubframe(sf);
+
+            if (sfbufklob.isEphemerisComplete())
+            {
+                bnav::SubframeBufferParam data = sfbufklob.flushEphemerisData();
+                CHECK(data.type == bnav::SubframeBufferType::D2_EPHEMERIS);
+                CHECK_EQUAL(1, data.framecount);
+                CHECK_EQUAL(2, data.data[0].size());
+                bnav::Ephemeris eph(data);
+                klobsets[eph.getSOW()] = std::make_pair(eph, msgcount);
+                ++klobcount;
+            }
+            else if (sfbufklob.isAlmanacComplete())
+            {
+                sfbufklob.flushAlmanacData();
+            }
+
+            if (sfbufall.isEphemerisComplete())
+            {
+                bnav::Ephemeris eph(sfbufall.flushEphemerisData());
+                auto it = klobsets.find(eph.getSOW());
+                CHECK(it != klobsets.end());
+                if (it != klobsets.end())
+                {
+                    CHECK(eph == it->second.first);
+                    CHECK_EQUAL(eph.getWeekNum(), it->second.first.getWeekNum());
+                    // complete after page 2, 8 frames before page 10
+                    CHECK_EQUAL(8 * 5, msgcount - it->second.second);
+                }
+                ++ephcount;
+            }
+            else if (sfbufall.isAlmanacComplete())
+            {
+                sfbufall.flushAlmanacData();
+            }
+        }
+        CHECK(ephcount > 0);
+        CHECK(klobcount >= ephcount);
+        reader.close();
+    }
+}
@@ -54,8 +54,10 @@ SUITE(testSubframeBufferStore_SBF_Superframe_OnePRN)
             ++msgcount;
         }
         CHECK_EQUAL(150, msgcount);
-        // we should have completed 30 ephemeris data sets
-        CHECK_EQUAL(30, ephcount);
+        // we should have completed 29 ephemeris data sets, subframe 3 of the
+        // last frame is missing and the one before the first frame belongs
+        // to another frame
+        CHECK_EQUAL(29, ephcount);
         // and 1 almanac data set
         CHECK_EQUAL(1, almcount);
         // all parities should be fine
@@ -245,3 +247,61 @@ SUITE(testSubframeBufferStore_SBF)
         reader.close();
     }
 }
+
+SUITE(testSubframeBufferStore_TypedAccess)
+{
+    // typed access returns the same buffers as getSubframeBuffer
+    TEST(testSubframeBufferStore_TypedGetters)
+    {
+        bnav::SubframeBufferStore sbstore;
+        const bnav::SvID geo(2), nongeo(6);
+
+        bnav::SubframeBufferD2 &sfbufd2 = sbstore.getSubframeBufferD2(geo);
+        bnav::SubframeBufferD1 &sfbufd1 = sbstore.getSubframeBufferD1(nongeo);
+        CHECK(sbstore.getSubframeBuffer(geo) == &sfbufd2);
+        CHECK(sbstore.getSubframeBuffer(nongeo) == &sfbufd1);
+        CHECK(&sbstore.getSubframeBufferD2(geo) == &sfbufd2);
+        CHECK(&sbstore.getSubframeBufferD1(nongeo) == &sfbufd1);
+        CHECK(!sbstore.hasIncompleteData());
+    }
+
+    TEST(testSubframeBufferStore_TypedSuperframeD1)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::SubframeBufferStore sbstore;
+
+        std::size_t ephcount = 0, almcount = 0;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            if (entry.getSignalType() != bnav::SignalType::BDS_B1)
+                continue;
+
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf;
+            sf.setBits(entry.getBits());
+            sf.initializeHeaderD1();
+            sf.initializeData();
+
+            bnav::SubframeBufferD1 &sfbuf = sbstore.getSubframeBufferD1(sv);
+            sfbuf.addSubframe(sf);
+
+            if (sfbuf.isEphemerisComplete())
+            {
+                sfbuf.flushEphemerisData();
+                ++ephcount;
+            }
+            else if (sfbuf.isAlmanacComplete())
+            {
+                sfbuf.flushAlmanacData();
+                ++almcount;
+            }
+        }
+        // same as with the untyped access
+        CHECK_EQUAL(29, ephcount);
+        CHECK_EQUAL(1, almcount);
+        reader.close();
+    }
+}
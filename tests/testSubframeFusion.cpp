@@ -0,0 +1,187 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+#include "TestHelper.h"
+
+#include "Subframe.h"
+#include "SubframeBuffer.h"
+#include "SubframeFusion.h"
+
+#include "AsciiReader.h"
+#include "BeiDou.h"
+#include "NavBits.h"
+#include "SvID.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// replace the 8 MSB of SOW in word 1 and choose the parity bits, so the
+// word is a valid code word again
+bnav::Subframe lcl_setSOWHigh(const bnav::SvID &sv, const bnav::Subframe &sf, const uint32_t high)
+{
+    bnav::NavBits<300> bits { sf.getBits() };
+    for (std::size_t i = 0; i < 8; ++i)
+        bits.setLeft(18 + i, ((high >> (7 - i)) & 1) != 0);
+
+    for (uint32_t parity = 0; parity < 16; ++parity)
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+            bits.setLeft(26 + i, ((parity >> (3 - i)) & 1) != 0);
+
+        const bnav::Subframe corrupt(sv, bits);
+        if (corrupt.getParityModifiedCount() == 0)
+            return corrupt;
+    }
+    return bnav::Subframe(sv, bits);
+}
+
+} // namespace
+
+SUITE(testSubframeFusion_SBF_Superframe)
+{
+    // two stations with gaps give all data sets of one complete station
+    TEST(testSubframeFusion_FillGapsD2)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt") };
+        CHECK_EQUAL(750, subframes.size());
+        const bnav::SvID sv(2);
+
+        bnav::SubframeFusion fusion;
+        bnav::SubframeBufferD2 sfbuf;
+
+        std::size_t forwardcount = 0, ephcount = 0, almcount = 0;
+        std::vector<bnav::Subframe> ready;
+        for (std::size_t i = 0; i < subframes.size(); ++i)
+        {
+            ready.clear();
+
+            // both stations miss every 5th subframe, but not the same
+            if (i % 5 != 0)
+                fusion.add(sv, subframes[i], ready);
+            if (i % 5 != 2)
+                fusion.add(sv, subframes[i], ready);
+
+            if (i + 1 == subframes.size())
+                fusion.flush(sv, ready);
+
+            for (const bnav::Subframe &fsf : ready)
+            {
+                ++forwardcount;
+                sfbuf.addSubframe(fsf);
+
+                if (sfbuf.isEphemerisComplete())
+                {
+                    sfbuf.flushEphemerisData();
+                    ++ephcount;
+                }
+                else if (sfbuf.isAlmanacComplete())
+                {
+                    sfbuf.flushAlmanacData();
+                    ++almcount;
+                }
+            }
+        }
+
+        CHECK_EQUAL(750, forwardcount);
+        CHECK_EQUAL(750 - 150 - 150, fusion.getDuplicateCount());
+        CHECK_EQUAL(0, fusion.getConflictCount());
+        CHECK_EQUAL(0, fusion.getLateCount());
+        // same as one complete station
+        CHECK_EQUAL(14, ephcount);
+        CHECK_EQUAL(1, almcount);
+    }
+
+    // subframes within the window are forwarded sorted, later ones are dropped
+    TEST(testSubframeFusion_ReorderD1)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt") };
+        CHECK(subframes.size() >= 4);
+        const bnav::SvID sv(6);
+
+        // one D1 subframe is 6s, keep two of them
+        bnav::SubframeFusion fusion(2 * bnav::D1_SUBFRAME_DURATION);
+        std::vector<bnav::Subframe> ready;
+
+        fusion.add(sv, subframes[1], ready);
+        fusion.add(sv, subframes[0], ready);
+        fusion.add(sv, subframes[2], ready);
+        CHECK(ready.empty());
+
+        fusion.add(sv, subframes[3], ready);
+        CHECK_EQUAL(1, ready.size());
+        CHECK(ready[0].isSameMessage(subframes[0]));
+
+        // already forwarded
+        fusion.add(sv, subframes[0], ready);
+        CHECK_EQUAL(1, fusion.getLateCount());
+
+        fusion.flush(sv, ready);
+        CHECK_EQUAL(4, ready.size());
+        for (std::size_t i = 0; i < ready.size(); ++i)
+            CHECK(ready[i].isSameMessage(subframes[i]));
+    }
+
+    // one corrupt SOW far before the newest one is no week change
+    TEST(testSubframeFusion_CorruptSOW)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt") };
+        CHECK_EQUAL(150, subframes.size());
+        const bnav::SvID sv(6);
+
+        const bnav::Subframe sfcorrupt { lcl_setSOWHigh(sv, subframes[5], 0) };
+        CHECK_EQUAL(0, sfcorrupt.getParityModifiedCount());
+        CHECK(sfcorrupt.getSOW() + bnav::SECONDS_OF_A_WEEK / 2 < subframes[4].getSOW());
+
+        bnav::SubframeFusion fusion(2 * bnav::D1_SUBFRAME_DURATION);
+        std::vector<bnav::Subframe> ready;
+        for (std::size_t i = 0; i < subframes.size(); ++i)
+        {
+            if (i == 5)
+                fusion.add(sv, sfcorrupt, ready);
+            fusion.add(sv, subframes[i], ready);
+        }
+        fusion.flush(sv, ready);
+
+        CHECK_EQUAL(1, fusion.getLateCount());
+        CHECK_EQUAL(subframes.size(), ready.size());
+        for (std::size_t i = 0; i < std::min(ready.size(), subframes.size()); ++i)
+            CHECK(ready[i].isSameMessage(subframes[i]));
+    }
+
+    // copies with different bits keep the one with less corrections
+    TEST(testSubframeFusion_Conflict)
+    {
+        const std::vector<bnav::Subframe> subframes { bnavtest::readSubframesB1(PATH_TESTDATA
+                    + "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt") };
+        const bnav::SvID sv(6);
+        const bnav::Subframe &sfref = subframes[0];
+        CHECK_EQUAL(0, sfref.getParityModifiedCount());
+        CHECK_EQUAL(sfref.getHash(), bnav::Subframe(sfref).getHash());
+
+        // two bits in one subword of word 4, see testSubframeMerger
+        bnav::NavBits<300> bits { sfref.getBits() };
+        bits.flipLeft(95);
+        bits.flipLeft(96);
+        const bnav::Subframe sfbroken(sv, bits);
+        CHECK(sfbroken.isSameMessage(sfref));
+        CHECK(sfbroken.getHash() != sfref.getHash());
+
+        bnav::SubframeFusion fusion;
+        std::vector<bnav::Subframe> ready;
+        fusion.add(sv, sfbroken, ready);
+        fusion.add(sv, sfref, ready);
+        fusion.add(sv, sfbroken, ready);
+        fusion.flush(sv, ready);
+
+        CHECK_EQUAL(1, ready.size());
+        CHECK(ready[0].getBits() == sfref.getBits());
+        CHECK_EQUAL(2, fusion.getConflictCount());
+        CHECK_EQUAL(0, fusion.getDuplicateCount());
+    }
+}
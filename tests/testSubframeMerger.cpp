@@ -0,0 +1,146 @@
+#include <UnitTest++/UnitTest++.h>
+#include "TestConfig.h"
+
+#include "Subframe.h"
+#include "SubframeBuffer.h"
+#include "SubframeMerger.h"
+
+#include "AsciiReader.h"
+#include "BeiDou.h"
+#include "NavBits.h"
+#include "SvID.h"
+
+#include <vector>
+
+SUITE(testSubframeMerger_SBF_Superframe)
+{
+    // B1 and B2 copies give every subframe once
+    TEST(testSubframeMerger_DuplicatesD2)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn2-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::SubframeMerger merger;
+        bnav::SubframeBufferD2 sfbuf;
+
+        std::size_t msgcount = 0, forwardcount = 0, ephcount = 0, almcount = 0;
+        std::vector<bnav::Subframe> ready;
+        bnav::AsciiReaderEntry entry;
+        while (reader.readLine(entry))
+        {
+            bnav::SvID sv(entry.getPRN());
+            bnav::Subframe sf(sv, entry.getBits());
+            ++msgcount;
+
+            ready.clear();
+            merger.add(sv, sf, ready);
+            CHECK(ready.size() <= 2);
+
+            for (const bnav::Subframe &msf : ready)
+            {
+                ++forwardcount;
+                sfbuf.addSubframe(msf);
+
+                if (sfbuf.isEphemerisComplete())
+                {
+                    sfbuf.flushEphemerisData();
+                    ++ephcount;
+                }
+                else if (sfbuf.isAlmanacComplete())
+                {
+                    sfbuf.flushAlmanacData();
+                    ++almcount;
+                }
+            }
+        }
+
+        ready.clear();
+        merger.flush(bnav::SvID(2), ready);
+        forwardcount += ready.size();
+
+        CHECK_EQUAL(1500, msgcount);
+        CHECK_EQUAL(750, forwardcount);
+        CHECK_EQUAL(750, merger.getDuplicateCount());
+        // same as B1 only
+        CHECK_EQUAL(14, ephcount);
+        CHECK_EQUAL(1, almcount);
+        reader.close();
+    }
+
+    // a broken word of one copy gets repaired by the other one
+    TEST(testSubframeMerger_RepairWord)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::AsciiReaderEntry entry;
+        CHECK(reader.readLine(entry));
+        const bnav::SvID sv(entry.getPRN());
+        const bnav::Subframe sfref(sv, entry.getBits());
+        CHECK_EQUAL(0, sfref.getParityModifiedCount());
+
+        // flip two bits in one subword of word 4, which BCH(15,11,1)
+        // can't correct
+        bnav::NavBits<300> bits { entry.getBits() };
+        bits.flipLeft(95);
+        bits.flipLeft(96);
+        const bnav::Subframe sfbroken(sv, bits);
+        CHECK(sfbroken.getWordModifiedCount(3) > 0);
+        CHECK(!(sfbroken.getBits() == sfref.getBits()));
+
+        bnav::SubframeMerger merger;
+        std::vector<bnav::Subframe> ready;
+
+        // corrected copy is held back
+        merger.add(sv, sfbroken, ready);
+        CHECK(ready.empty());
+
+        merger.add(sv, sfref, ready);
+        CHECK_EQUAL(1, ready.size());
+        CHECK(ready[0].getBits() == sfref.getBits());
+        CHECK_EQUAL(0, ready[0].getParityModifiedCount());
+        CHECK_EQUAL(1, merger.getRepairedWordCount());
+
+        // no more copies of it
+        ready.clear();
+        merger.add(sv, sfbroken, ready);
+        CHECK(ready.empty());
+        merger.flush(sv, ready);
+        CHECK(ready.empty());
+        reader.close();
+    }
+
+    // without a twin the corrected copy leaves with the next subframe
+    TEST(testSubframeMerger_NoTwin)
+    {
+        bnav::AsciiReader reader(PATH_TESTDATA+ "sbf/subframebuffer/CUT12014071724.sbf_SBF_CMPRaw-prn6-onesuperframe.txt",
+                                 bnav::AsciiReaderType::TEXT_CONVERTED_SBF);
+
+        bnav::AsciiReaderEntry entry;
+        CHECK(reader.readLine(entry));
+        const bnav::SvID sv(entry.getPRN());
+
+        bnav::NavBits<300> bits { entry.getBits() };
+        bits.flipLeft(100);
+        const bnav::Subframe sfcorrected(sv, bits);
+        CHECK_EQUAL(1, sfcorrected.getParityModifiedCount());
+
+        // next subframe on B1
+        while (reader.readLine(entry) && entry.getSignalType() != bnav::SignalType::BDS_B1)
+            ;
+        const bnav::Subframe sfnext(sv, entry.getBits());
+        CHECK(!sfnext.isSameMessage(sfcorrected));
+
+        bnav::SubframeMerger merger;
+        std::vector<bnav::Subframe> ready;
+
+        merger.add(sv, sfcorrected, ready);
+        CHECK(ready.empty());
+        merger.add(sv, sfnext, ready);
+        CHECK_EQUAL(2, ready.size());
+        CHECK(ready[0].isSameMessage(sfcorrected));
+        CHECK(ready[1].isSameMessage(sfnext));
+        CHECK_EQUAL(0, merger.getDuplicateCount());
+        reader.close();
+    }
+}
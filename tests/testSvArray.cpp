@@ -0,0 +1,56 @@
+#include <UnitTest++/UnitTest++.h>
+
+#include "BeiDou.h"
+#include "SvArray.h"
+#include "SvID.h"
+
+#include <memory>
+#include <vector>
+
+SUITE(testSvArray)
+{
+    TEST(testSvArray_InsertGet)
+    {
+        bnav::SvArray<uint32_t> items;
+        CHECK(items.empty());
+        CHECK_EQUAL(0, items.size());
+
+        const bnav::SvID sv1(1), sv37(bnav::BDS_MAX_PRN);
+        CHECK(!items.contains(sv1));
+        CHECK(!items.contains(sv37));
+
+        items.insert(sv37) = 37;
+        items.insert(sv1) = 1;
+        CHECK(items.contains(sv1));
+        CHECK(items.contains(sv37));
+        CHECK(!items.contains(bnav::SvID(2)));
+        CHECK_EQUAL(2, items.size());
+        CHECK_EQUAL(1, items.get(sv1));
+        CHECK_EQUAL(37, items.get(sv37));
+
+        // insert keeps an existing item
+        ++items.insert(sv1);
+        CHECK_EQUAL(2, items.get(sv1));
+        CHECK_EQUAL(2, items.size());
+    }
+
+    // SvIDs are sorted by PRN, independent of insertion order
+    TEST(testSvArray_SvList)
+    {
+        bnav::SvArray< std::unique_ptr<int> > items;
+        CHECK(items.getSvList().empty());
+
+        for (const uint32_t prn : {14u, 2u, 6u, 1u})
+            items.insert(bnav::SvID(prn)).reset(new int(static_cast<int>(prn)));
+
+        const std::vector<bnav::SvID> svlist = items.getSvList();
+        CHECK_EQUAL(4, svlist.size());
+        CHECK_EQUAL(1, svlist[0].getPRN());
+        CHECK_EQUAL(2, svlist[1].getPRN());
+        CHECK_EQUAL(6, svlist[2].getPRN());
+        CHECK_EQUAL(14, svlist[3].getPRN());
+
+        for (const bnav::SvID &sv : svlist)
+            CHECK_EQUAL(static_cast<int>(sv.getPRN()), *items.get(sv));
+    }
+}
@@ -0,0 +1,120 @@
+#include <UnitTest++/UnitTest++.h>
+
+#include "TimeSeriesStore.h"
+
+#include "BeiDou.h"
+#include "DateTime.h"
+#include "Ephemeris.h"
+#include "SvID.h"
+
+#include <vector>
+
+SUITE(testTimeSeriesStore)
+{
+    TEST(testTimeSeries_Insert)
+    {
+        bnav::TimeSeries<uint32_t> series;
+        CHECK(series.empty());
+
+        series.insert(bnav::DateTime(bnav::TimeSystem::BDT, 452, 3600), 2);
+        series.insert(bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200), 3);
+        // older epoch, next week and replacement
+        series.insert(bnav::DateTime(bnav::TimeSystem::BDT, 452, 0), 1);
+        series.insert(bnav::DateTime(bnav::TimeSystem::BDT, 453, 0), 4);
+        series.insert(bnav::DateTime(bnav::TimeSystem::BDT, 452, 3600), 5);
+        CHECK_EQUAL(4, series.size());
+
+        const std::vector<uint32_t> items(series.begin(), series.end());
+        CHECK(items == std::vector<uint32_t>({ 1, 5, 3, 4 }));
+        CHECK_EQUAL(453 * bnav::SECONDS_OF_A_WEEK, series.getEpoch(3));
+        CHECK(series.getDateTime(2) == bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200));
+        CHECK_EQUAL(5, series.at(bnav::DateTime(bnav::TimeSystem::BDT, 452, 3600)));
+
+        series.clear();
+        CHECK(series.empty());
+    }
+
+    TEST(testTimeSeries_Lookup)
+    {
+        bnav::TimeSeries<uint32_t> series;
+        for (uint32_t i = 0; i < 4; ++i)
+            series.insert(bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200 * i), i);
+
+        CHECK_EQUAL(2, series.find(bnav::DateTime(bnav::TimeSystem::BDT, 452, 14400)));
+        CHECK_EQUAL(series.size(), series.find(bnav::DateTime(bnav::TimeSystem::BDT, 452, 14401)));
+
+        // latest at or before
+        CHECK_EQUAL(2, series.findLatest(bnav::DateTime(bnav::TimeSystem::BDT, 452, 14400)));
+        CHECK_EQUAL(2, series.findLatest(bnav::DateTime(bnav::TimeSystem::BDT, 452, 21599)));
+        CHECK_EQUAL(3, series.findLatest(bnav::DateTime(bnav::TimeSystem::BDT, 453, 0)));
+        CHECK_EQUAL(series.size(), series.findLatest(bnav::DateTime(bnav::TimeSystem::BDT, 451, 0)));
+
+        // both ends are included
+        auto range = series.getRange(bnav::DateTime(bnav::TimeSystem::BDT, 452, 3600), bnav::DateTime(bnav::TimeSystem::BDT, 452, 14400));
+        CHECK(std::vector<uint32_t>(range.first, range.second) == std::vector<uint32_t>({ 1, 2 }));
+        range = series.getRange(bnav::DateTime(bnav::TimeSystem::BDT, 452, 0), bnav::DateTime(bnav::TimeSystem::BDT, 452, 0));
+        CHECK_EQUAL(1, range.second - range.first);
+        range = series.getRange(bnav::DateTime(bnav::TimeSystem::BDT, 453, 0), bnav::DateTime(bnav::TimeSystem::BDT, 454, 0));
+        CHECK(range.first == range.second);
+    }
+
+    TEST(testTimeSeries_Evict)
+    {
+        bnav::TimeSeries<uint32_t> series;
+        for (uint32_t i = 0; i < 5; ++i)
+            series.insert(bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200 * i), i);
+
+        std::vector<uint32_t> evicted;
+        series.evict(2, [&evicted](uint32_t &item) { evicted.push_back(item); });
+        CHECK(evicted == std::vector<uint32_t>({ 0, 1 }));
+
+        // evicted items are skipped by all lookups
+        CHECK_EQUAL(3, series.size());
+        CHECK_EQUAL(2, series.front());
+        CHECK_EQUAL(0, series.find(bnav::DateTime(bnav::TimeSystem::BDT, 452, 14400)));
+        CHECK_EQUAL(series.size(), series.find(bnav::DateTime(bnav::TimeSystem::BDT, 452, 0)));
+        CHECK_EQUAL(series.size(), series.findLatest(bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200)));
+        CHECK_EQUAL(2, series.countBefore(bnav::TimeSeries<uint32_t>::toEpoch(bnav::DateTime(bnav::TimeSystem::BDT, 452, 28800))));
+        CHECK(std::vector<uint32_t>(series.begin(), series.end()) == std::vector<uint32_t>({ 2, 3, 4 }));
+
+        // older items are inserted after the evicted ones
+        series.insert(bnav::DateTime(bnav::TimeSystem::BDT, 452, 3600), 9);
+        CHECK_EQUAL(9, series[0]);
+        CHECK_EQUAL(3600, series.getDateTime(0).getSOW());
+
+        series.evict(3, [](uint32_t &) {});
+        CHECK(std::vector<uint32_t>(series.begin(), series.end()) == std::vector<uint32_t>({ 4 }));
+        series.evict(1, [](uint32_t &) {});
+        CHECK(series.empty());
+    }
+
+    TEST(testTimeSeriesStore_Sv)
+    {
+        bnav::TimeSeriesStore<bnav::KlobucharParam> store;
+        CHECK(store.empty());
+
+        bnav::KlobucharParam klob;
+        klob.alpha0 = 1.0e-08;
+        store.insert(bnav::SvID(5), bnav::DateTime(bnav::TimeSystem::BDT, 452, 0), klob);
+        klob.alpha0 = 2.0e-08;
+        store.insert(bnav::SvID(5), bnav::DateTime(bnav::TimeSystem::BDT, 452, 7200), klob);
+        store.insert(bnav::SvID(1), bnav::DateTime(bnav::TimeSystem::BDT, 452, 0), klob);
+
+        CHECK(store.hasDataForSv(bnav::SvID(5)));
+        CHECK(!store.hasDataForSv(bnav::SvID(2)));
+        CHECK(store.getSvList() == std::vector<bnav::SvID>({ bnav::SvID(1), bnav::SvID(5) }));
+
+        const bnav::TimeSeries<bnav::KlobucharParam> &series = store.get(bnav::SvID(5));
+        CHECK_EQUAL(2, series.size());
+        CHECK_EQUAL(1.0e-08, series[series.findLatest(bnav::DateTime(bnav::TimeSystem::BDT, 452, 7199))].alpha0);
+
+        // emptied SV is kept without data
+        store.get(bnav::SvID(1)).clear();
+        CHECK(store.contains(bnav::SvID(1)));
+        CHECK(!store.hasDataForSv(bnav::SvID(1)));
+
+        bnav::TimeSeriesStore<bnav::Ephemeris> ephstore;
+        ephstore.insert(bnav::SvID(3), bnav::DateTime(bnav::TimeSystem::BDT, 452, 0), bnav::Ephemeris());
+        CHECK(ephstore.hasDataForSv(bnav::SvID(3)));
+    }
+}
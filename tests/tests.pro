@@ -3,7 +3,7 @@
 }
 
 TEMPLATE = app
-CONFIG += console
+CONFIG += console thread
 CONFIG -= app_bundle
 
 LIBS += -lUnitTest++ -L../lib -lbnav
@@ -20,7 +20,23 @@ SOURCES += main.cpp \
     testDateTime.cpp \
     testSamples.cpp \
     testEphemeris.cpp \
-    testIonosphereGridInfo.cpp
+    testIonosphereGridInfo.cpp \
+    testPageFilter.cpp \
+    testSvArray.cpp \
+    testSubframeMerger.cpp \
+    testIonospherePool.cpp \
+    testSubframeFusion.cpp \
+    testPageVoter.cpp \
+    testIonosphereConsensus.cpp \
+    testKlobucharEvaluator.cpp \
+    testKlobucharMapGenerator.cpp \
+    testIonosphereInterpolator.cpp \
+    testSlantDelayEvaluator.cpp \
+    testIonosphereGrid.cpp \
+    testTimeSeriesStore.cpp \
+    testIonosphereStore.cpp \
+    testIonosphereSnapshot.cpp
 
 HEADERS += \
-    TestConfig.h
+    TestConfig.h \
+    TestHelper.h